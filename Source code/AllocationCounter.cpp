@@ -0,0 +1,158 @@
+﻿#define NOMINMAX
+#include "AllocationCounter.h"
+#include <QFile>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <malloc.h>
+#endif
+
+namespace {
+std::atomic<quint64> g_allocations(0);
+std::atomic<quint64> g_deallocations(0);
+
+#ifdef SCHEDULE_COUNT_ALLOCATIONS
+void* countedAlloc(std::size_t size)
+{
+    void* p = std::malloc(size ? size : 1);
+    if (p) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return p;
+}
+
+void countedFree(void* p) noexcept
+{
+    if (p) {
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+        std::free(p);
+    }
+}
+#endif
+}
+
+bool AllocationCounter::isEnabled()
+{
+#ifdef SCHEDULE_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 AllocationCounter::allocations()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+quint64 AllocationCounter::deallocations()
+{
+    return g_deallocations.load(std::memory_order_relaxed);
+}
+
+qint64 AllocationCounter::heapBytes()
+{
+#ifdef Q_OS_WIN
+    HEAP_SUMMARY summary;
+    summary.cb = sizeof(summary);
+    if (HeapSummary(GetProcessHeap(), 0, &summary)) {
+        return qint64(summary.cbAllocated);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return qint64(mallinfo2().uordblks);
+#else
+    return -1;
+#endif
+}
+
+qint64 AllocationCounter::privateBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        return qint64(counters.PrivateUsage);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    // 匿名常驻内存近似私有字节
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("RssAnon:")) {
+            return line.mid(8).trimmed().split(' ').value(0).toLongLong() * 1024;
+        }
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+#ifdef SCHEDULE_COUNT_ALLOCATIONS
+void* operator new(std::size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    countedFree(p);
+}
+#endif // SCHEDULE_COUNT_ALLOCATIONS
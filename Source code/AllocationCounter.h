@@ -0,0 +1,28 @@
+﻿#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <QtGlobal>
+
+// 全局 operator new/delete 计数，只是一次原子自增，供浸泡测试观察堆分配是否持续增长。
+// 替换全局 operator new/delete 只在定义了 SCHEDULE_COUNT_ALLOCATIONS 的诊断构建中启用，
+// 发布版本不替换；未启用时 isEnabled() 返回 false，计数恒为 0。
+// 注意 MSVC 下各 Qt DLL 内部的分配不经过这里，进程级的泄漏判断以私有字节为准。
+namespace AllocationCounter
+{
+bool isEnabled();
+quint64 allocations();
+quint64 deallocations();
+
+// 当前未释放的分配数
+inline qint64 liveAllocations()
+{
+    return qint64(allocations() - deallocations());
+}
+
+// 进程堆当前已分配的字节数（平台不支持时返回 -1）
+qint64 heapBytes();
+// 进程私有字节数（提交的私有内存，包括所有 DLL 的分配；平台不支持时返回 -1）
+qint64 privateBytes();
+}
+
+#endif // ALLOCATION_COUNTER_H
@@ -1,6 +1,15 @@
 ﻿#define NOMINMAX
 #include "ClassScheduleApp.h"
 #include "TimeWindow.h"
+#include "ClockSource.h"
+#include "PaintProfiler.h"
+#include "EventLoopMonitor.h"
+#include "NoticeTicker.h"
+#include "ScheduleEditorDialog.h"
+#include "PanelScheduler.h"
+#include "ExamCountdownPanel.h"
+#include "DutyRosterPanel.h"
+#include "NextPeriodPanel.h"
 #include <QApplication>
 #include <QCoreApplication>
 #include <QScreen>
@@ -13,6 +22,8 @@
 #include <QVBoxLayout>
 #include <QMessageBox>
 #include <QProcess>
+#include <QElapsedTimer>
+#include <QShortcut>
 #include <random>
 
 #ifdef Q_OS_WIN
@@ -20,36 +31,45 @@
 #include <winreg.h>
 #endif
 
-ClassScheduleApp::ClassScheduleApp(QWidget* parent)
+ClassScheduleApp::ClassScheduleApp(const AppOptions& options, SettingsModel* model, QScreen* screen, QWidget* parent)
     : QMainWindow(parent),
     centralWidget(nullptr), mainLayout(nullptr),
     courseListWidget(nullptr), courseListLayout(nullptr), courseScrollArea(nullptr),
-    restartBtn(nullptr), closeBtn(nullptr),
+    displayedDay(-1),
+    panelScheduler(nullptr),
+    noticeTicker(nullptr),
+    editBtn(nullptr), restartBtn(nullptr), closeBtn(nullptr),
     datetimeTimer(nullptr), topmostCheckTimer(nullptr), pixelShiftTimer(nullptr),
-    timeWindow(nullptr),
-    currentTopmostState(false), currentWeekday(-1), pixelShiftCount(0)
+    timeWindow(nullptr), paintProfiler(nullptr), eventLoopMonitor(nullptr),
+    options(options),
+    settingsModel(model ? model : new SettingsModel(options.settingsPath, options.persistSettings)),
+    ownsSettingsModel(model == nullptr),
+    settings(settingsModel->settings()),
+    boardScreen(nullptr),
+    currentTopmostState(false), pixelShiftCount(0),
+    lastModeSwitchMs(0.0)
 {
     qDebug() << "=== 应用程序启动 ===";
 
-    // 加载设置
-    loadSettings();
+    // 加载设置（共享模型由创建者负责加载）
+    if (ownsSettingsModel) {
+        settingsModel->setParent(this);
+        settingsModel->load();
+    }
 
     // 设置无边框窗口和透明背景
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnBottomHint);
     setAttribute(Qt::WA_TranslucentBackground);
 
-    // 设置窗口位置和大小
-    QScreen* screen = QApplication::primaryScreen();
-    QRect screenGeometry = screen->geometry();
-    int windowWidth = 600;
-    int windowHeight = screenGeometry.height();
-    setGeometry(screenGeometry.width() - windowWidth, 0, windowWidth, windowHeight);
-
     // 设置透明度
     setWindowOpacity(settings.transparency);
 
     // 创建时间窗口
     timeWindow = new TimeWindow();
+    connect(timeWindow, &TimeWindow::dragFinished, this, &ClassScheduleApp::onClockDragged);
+
+    // 设置窗口位置和大小（课程表和时间窗口都放在所在屏幕的右侧）
+    setBoardScreen(screen ? screen : QApplication::primaryScreen());
 
     // 初始检查状态
     bool initialTopmost = shouldBeTopmost();
@@ -68,20 +88,55 @@ ClassScheduleApp::ClassScheduleApp(QWidget* parent)
     timeWindow->show();
     timeWindow->raise();
 
+    // 先于界面创建，销毁时先于面板移除事件过滤
+    panelScheduler = new PanelScheduler(this);
+
     setupUI();
 
+    // 绘制分析叠加层：隐藏快捷键或命令行开启，关闭时不挂任何钩子
+    paintProfiler = new PaintProfiler(this);
+    paintProfiler->attach(this);
+    paintProfiler->attach(timeWindow);
+    if (options.profilerShortcut) {
+        QShortcut* profilerShortcut = new QShortcut(QKeySequence("Ctrl+Alt+Shift+P"), this);
+        profilerShortcut->setContext(Qt::ApplicationShortcut);
+        connect(profilerShortcut, &QShortcut::activated, paintProfiler, &PaintProfiler::toggle);
+    }
+    paintProfiler->setEnabled(options.profileOverlay);
+
     // 初始检查状态
     toggleDisplayMode(initialTopmost);
     currentTopmostState = initialTopmost;
 
     startTimers();
-    setAutoStart();
+
+    // 其他实例修改设置或重新加载后，同步到本实例
+    connect(settingsModel, &SettingsModel::settingsReloaded, this, &ClassScheduleApp::applySettings);
+    connect(settingsModel, &SettingsModel::courseChanged, this, &ClassScheduleApp::onCourseChanged);
+    connect(settingsModel, &SettingsModel::dayChanged, this, &ClassScheduleApp::onDayChanged);
+    connect(settingsModel, &SettingsModel::courseFontSizeChanged, this, &ClassScheduleApp::applyCourseFontSize);
+    connect(settingsModel, &SettingsModel::transparencyChanged, this, &ClassScheduleApp::applyTransparency);
+    connect(settingsModel, &SettingsModel::topmostTimeRangesChanged, this, &ClassScheduleApp::checkTopmostStatus);
+
+    // 事件循环卡顿监控（模拟模式下没有真实事件循环，不启用）
+    if (options.monitorEventLoop) {
+        eventLoopMonitor = new EventLoopMonitor(settings.stallThresholdMs, this);
+        eventLoopMonitor->start();
+    }
+
+    if (options.autoStart) {
+        setAutoStart();
+    }
 
     qDebug() << "=== 应用程序初始化完成 ===";
 }
 
 ClassScheduleApp::~ClassScheduleApp()
 {
+    if (eventLoopMonitor) {
+        eventLoopMonitor->stop();
+    }
+
     // 停止所有定时器
     if (datetimeTimer) {
         datetimeTimer->stop();
@@ -102,7 +157,175 @@ ClassScheduleApp::~ClassScheduleApp()
         timeWindow->deleteLater();
     }
 
-    saveSettings();
+    if (ownsSettingsModel) {
+        settingsModel->save();
+    }
+}
+
+void ClassScheduleApp::setBoardScreen(QScreen* screen)
+{
+    if (!screen || screen == boardScreen) {
+        return;
+    }
+
+    for (const QMetaObject::Connection& connection : screenConnections) {
+        disconnect(connection);
+    }
+    screenConnections.clear();
+
+    boardScreen = screen;
+    qDebug() << "课程表所在屏幕:" << screen->name() << screen->geometry();
+
+    // 只有本实例所在屏幕的变化才需要重新布局
+    screenConnections.push_back(connect(screen, &QScreen::geometryChanged, this, &ClassScheduleApp::applyScreenGeometry));
+    screenConnections.push_back(connect(screen, &QScreen::logicalDotsPerInchChanged, this, &ClassScheduleApp::applyScreenGeometry));
+
+    applyScreenGeometry();
+}
+
+void ClassScheduleApp::applyScreenGeometry()
+{
+    if (!boardScreen) {
+        return;
+    }
+
+    QRect screenGeometry = boardScreen->geometry();
+    int windowWidth = 600;
+    setGeometry(screenGeometry.x() + screenGeometry.width() - windowWidth, screenGeometry.y(),
+        windowWidth, screenGeometry.height());
+
+    if (timeWindow) {
+        timeWindow->placeOnScreen(screenGeometry);
+        timeWindow->move(clockBasePosition(screenGeometry));
+    }
+
+    qDebug() << "按屏幕重新布局:" << boardScreen->name() << screenGeometry
+        << "DPI:" << boardScreen->logicalDotsPerInch();
+}
+
+QPoint ClassScheduleApp::clockBasePosition(const QRect& screenGeometry) const
+{
+    auto it = boardScreen ? settings.clockPositions.constFind(boardScreen->name()) : settings.clockPositions.constEnd();
+    if (it == settings.clockPositions.constEnd() || !timeWindow) {
+        return TimeWindow::defaultPosition(screenGeometry);
+    }
+
+    // 分辨率变小后保证时间窗口仍在屏幕内
+    return clampClockPosition(screenGeometry, screenGeometry.topLeft() + it.value());
+}
+
+QPoint ClassScheduleApp::clampClockPosition(const QRect& screenGeometry, const QPoint& position) const
+{
+    QPoint clamped = position;
+    clamped.setX(qBound(screenGeometry.left(), clamped.x(), screenGeometry.right() - timeWindow->width() + 1));
+    clamped.setY(qBound(screenGeometry.top(), clamped.y(), screenGeometry.bottom() - timeWindow->height() + 1));
+    return clamped;
+}
+
+void ClassScheduleApp::onClockDragged(const QPoint& topLeft)
+{
+    if (!boardScreen || !timeWindow) {
+        return;
+    }
+
+    // 每个屏幕有自己的实例和时间窗口，拖到其他屏幕上时放回本屏幕的边缘，
+    // 否则保存的偏移在下次防烧屏偏移时才被限制回来，窗口会突然跳动
+    const QRect screenGeometry = boardScreen->geometry();
+    const QPoint position = clampClockPosition(screenGeometry, topLeft);
+    if (position != topLeft) {
+        QScreen* dropScreen = QGuiApplication::screenAt(topLeft);
+        qDebug() << "时间窗口被拖出所在屏幕" << (dropScreen ? dropScreen->name() : QString())
+            << "，放回" << boardScreen->name();
+        timeWindow->move(position);
+    }
+
+    const QPoint offset = position - screenGeometry.topLeft();
+    settingsModel->setClockPosition(boardScreen->name(), offset);
+    qDebug() << "时间窗口位置已保存:" << boardScreen->name() << offset;
+}
+
+void ClassScheduleApp::applySettings()
+{
+    // 设置重新加载后刷新显示
+    if (!currentTopmostState) {
+        setWindowOpacity(settings.transparency);
+        if (timeWindow) {
+            timeWindow->setTransparency(settings.transparency);
+        }
+    }
+    createCourseList();
+    checkTopmostStatus();
+    panelScheduler->reloadPanels();
+}
+
+void ClassScheduleApp::onCourseChanged(int day, int row)
+{
+    // 面板按日期从模型取课程，日历规则生效时也可能引用被修改的星期或模板
+    panelScheduler->refreshAll();
+    if (displayedDay < 0) {
+        // 日历规则生效时无法确定改动是否影响当前课表，直接重建
+        createCourseList();
+        return;
+    }
+    if (day != displayedDay) {
+        return;
+    }
+
+    // 只改对应标签的文字；空课程没有标签，需要增删标签时才重建
+    const QString& course = settings.schedules.day(day).value(row);
+    if (row >= 0 && row < int(courseLabels.size()) && courseLabels[row] && !course.isEmpty()) {
+        courseLabels[row]->setText(course);
+        qDebug() << "更新课程行" << row << ":" << course;
+    }
+    else {
+        createCourseList();
+    }
+}
+
+void ClassScheduleApp::onDayChanged(int day)
+{
+    panelScheduler->refreshAll();
+    // 日历规则生效时（displayedDay 为 -1）引用的星期或模板也可能被修改
+    if (day == displayedDay || displayedDay < 0) {
+        createCourseList();
+    }
+}
+
+void ClassScheduleApp::applyCourseFontSize(int size)
+{
+    qDebug() << "课程字体大小改为:" << size;
+    const QString style = courseLabelStyle();
+    for (QLabel* label : courseLabels) {
+        if (label) {
+            label->setStyleSheet(style);
+        }
+    }
+    panelScheduler->reloadPanels();
+}
+
+void ClassScheduleApp::applyTransparency(double transparency)
+{
+    // 置顶模式使用固定透明度，切回正常模式时再应用
+    if (!currentTopmostState) {
+        setWindowOpacity(transparency);
+        setTimeWindowTransparency(transparency);
+    }
+}
+
+void ClassScheduleApp::openEditor()
+{
+    if (!editorDialog) {
+        editorDialog = new ScheduleEditorDialog(settingsModel, this);
+        editorDialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    editorDialog->show();
+    editorDialog->raise();
+    editorDialog->activateWindow();
+}
+
+QString ClassScheduleApp::courseLabelStyle() const
+{
+    return QString("font-size: %1px; font-weight: bold; color: black; background: transparent;").arg(settings.courseFontSize);
 }
 
 void ClassScheduleApp::setupUI()
@@ -124,6 +347,7 @@ void ClassScheduleApp::setupUI()
         QHBoxLayout* controlLayout = new QHBoxLayout();
         controlLayout->setContentsMargins(0, 0, 0, 0);
 
+        editBtn = new QPushButton("编辑", centralWidget);
         restartBtn = new QPushButton("重启", centralWidget);
         closeBtn = new QPushButton("关闭", centralWidget);
 
@@ -140,13 +364,16 @@ void ClassScheduleApp::setupUI()
             "background: rgba(255, 255, 255, 220); "
             "}";
 
+        editBtn->setStyleSheet(buttonStyle);
         restartBtn->setStyleSheet(buttonStyle);
         closeBtn->setStyleSheet(buttonStyle);
 
+        connect(editBtn, &QPushButton::clicked, this, &ClassScheduleApp::openEditor);
         connect(restartBtn, &QPushButton::clicked, this, &ClassScheduleApp::restartApp);
         connect(closeBtn, &QPushButton::clicked, this, &QApplication::quit);
 
         controlLayout->addStretch();
+        controlLayout->addWidget(editBtn);
         controlLayout->addWidget(restartBtn);
         controlLayout->addWidget(closeBtn);
 
@@ -154,6 +381,7 @@ void ClassScheduleApp::setupUI()
 
         // 课程列表区域 - 恢复正常间距
         courseScrollArea = new QScrollArea(centralWidget);
+        courseScrollArea->setObjectName("courseScrollArea");
         courseScrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
         courseScrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
         courseScrollArea->setWidgetResizable(true);
@@ -163,6 +391,7 @@ void ClassScheduleApp::setupUI()
 
         // 创建课程列表容器
         courseListWidget = new QWidget();
+        courseListWidget->setObjectName("courseListWidget");
         courseListWidget->setStyleSheet("background: transparent;");
         courseListLayout = new QVBoxLayout(courseListWidget);
         courseListLayout->setAlignment(Qt::AlignTop);
@@ -175,6 +404,23 @@ void ClassScheduleApp::setupUI()
         courseScrollArea->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
         mainLayout->addWidget(courseScrollArea, 1); // 添加拉伸因子
 
+        // 课程列表下方的信息面板，未配置的面板不显示
+        const std::vector<InfoPanel*> panels = {
+            new NextPeriodPanel(settingsModel, centralWidget),
+            new ExamCountdownPanel(settingsModel, centralWidget),
+            new DutyRosterPanel(settingsModel, centralWidget)
+        };
+        for (InfoPanel* panel : panels) {
+            mainLayout->addWidget(panel);
+            panelScheduler->addPanel(panel);
+        }
+
+        // 课程列表下方的滚动通知栏，没有通知时自动隐藏
+        QString noticePath = QFileInfo(settingsModel->filePath()).absoluteDir().absoluteFilePath(settings.noticeFile);
+        noticeTicker = new NoticeTicker(noticePath, settings.noticeFontSize, settings.noticeSpeed, centralWidget);
+        noticeTicker->setObjectName("noticeTicker");
+        mainLayout->addWidget(noticeTicker);
+
         // 初始创建课程列表
         createCourseList();
 
@@ -191,176 +437,9 @@ void ClassScheduleApp::setupUI()
     }
 }
 
-void ClassScheduleApp::loadSettings()
-{
-    qDebug() << "=== 开始加载设置 ===";
-
-    // 使用应用程序目录的绝对路径
-    QString settingsPath = QCoreApplication::applicationDirPath() + "/class_schedule_settings.json";
-    QFile file(settingsPath);
-
-    qDebug() << "设置文件路径:" << settingsPath;
-
-    if (file.exists() && file.open(QIODevice::ReadOnly)) {
-        qDebug() << "找到设置文件，文件大小:" << file.size();
-
-        QByteArray data = file.readAll();
-        file.close();
-
-        if (!data.isEmpty()) {
-            QJsonDocument doc = QJsonDocument::fromJson(data);
-            if (!doc.isNull()) {
-                QJsonObject obj = doc.object();
-
-                settings.transparency = obj.value("transparency").toDouble(1.0);
-                settings.dateFontSize = obj.value("date_font_size").toInt(16);
-                settings.timeFontSize = obj.value("time_font_size").toInt(48);
-                settings.courseFontSize = obj.value("course_font_size").toInt(28);
-
-                qDebug() << "透明度设置:" << settings.transparency;
-                qDebug() << "日期字体大小:" << settings.dateFontSize;
-                qDebug() << "时间字体大小:" << settings.timeFontSize;
-                qDebug() << "课程字体大小:" << settings.courseFontSize;
-
-                // 加载时间段设置
-                QJsonArray timeRanges = obj.value("topmost_time_ranges").toArray();
-                settings.topmostTimeRanges.clear();
-                qDebug() << "时间段数量:" << timeRanges.size();
-                for (const QJsonValue& value : timeRanges) {
-                    QJsonObject range = value.toObject();
-                    TimeRange tr;
-                    tr.start = range.value("start").toString("08:00");
-                    tr.end = range.value("end").toString("12:00");
-                    settings.topmostTimeRanges.push_back(tr);
-                    qDebug() << "时间段:" << tr.start << "-" << tr.end;
-                }
-
-                // 加载课程表
-                QJsonObject schedules = obj.value("schedules").toObject();
-                QStringList weekdays = { "Monday", "Tuesday", "Wednesday", "Thursday",
-                                       "Friday", "Saturday", "Sunday" };
-
-                qDebug() << "JSON中的课程表键:" << schedules.keys();
-
-                for (const QString& day : weekdays) {
-                    if (schedules.contains(day)) {
-                        QJsonArray courses = schedules.value(day).toArray();
-                        QStringList courseList;
-                        for (const QJsonValue& course : courses) {
-                            courseList.append(course.toString());
-                        }
-                        settings.schedules[day] = courseList;
-                        qDebug() << day << "的课程数量:" << courseList.size();
-                    }
-                    else {
-                        // 如果没有该星期的课程表，使用默认值
-                        qDebug() << day << "没有课程表，使用默认值";
-                        QStringList defaultCourses = { "早读", "第一节", "第二节", "第三节", "第四节",
-                                                     "第五节", "限时一", "第六节", "第七节", "第八节",
-                                                     "限时二", "限时三", "第九节", "第十节", "第十一节" };
-                        settings.schedules[day] = defaultCourses;
-                    }
-                }
-
-                // 应用透明度设置到时间窗口（仅在非置顶模式下）
-                if (timeWindow && !currentTopmostState) {
-                    timeWindow->setTransparency(settings.transparency);
-                }
-
-                QStringList loadedDays;
-                for (const auto& pair : settings.schedules) {
-                    loadedDays.append(pair.first);
-                }
-                qDebug() << "已加载的星期:" << loadedDays;
-
-                qDebug() << "设置加载成功";
-                return; // 成功加载，直接返回
-            }
-        }
-    }
-
-    // 如果文件不存在或读取失败，创建默认设置
-    qDebug() << "使用默认设置";
-    createDefaultSettings();
-}
-
-void ClassScheduleApp::createDefaultSettings()
-{
-    settings.transparency = 1.0;
-    settings.dateFontSize = 16;
-    settings.timeFontSize = 48;
-    settings.courseFontSize = 28;
-
-    // 默认时间段
-    settings.topmostTimeRanges.clear();
-    settings.topmostTimeRanges.push_back({ "08:00", "12:00" });
-    settings.topmostTimeRanges.push_back({ "14:00", "18:00" });
-
-    // 默认课程表
-    QStringList defaultCourses = { "早读", "第一节", "第二节", "第三节", "第四节",
-                                 "第五节", "限时一", "第六节", "第七节", "第八节",
-                                 "限时二", "限时三", "第九节", "第十节", "第十一节" };
-
-    QStringList weekdays = { "Monday", "Tuesday", "Wednesday", "Thursday",
-                           "Friday", "Saturday", "Sunday" };
-    for (const QString& day : weekdays) {
-        settings.schedules[day] = defaultCourses;
-    }
-
-    // 保存默认设置
-    saveSettings();
-}
-
-void ClassScheduleApp::saveSettings()
-{
-    // 使用应用程序目录的绝对路径
-    QString settingsPath = QCoreApplication::applicationDirPath() + "/class_schedule_settings.json";
-    QFile file(settingsPath);
-
-    qDebug() << "保存设置到:" << settingsPath;
-
-    QJsonObject obj;
-    obj["transparency"] = settings.transparency;
-    obj["date_font_size"] = settings.dateFontSize;
-    obj["time_font_size"] = settings.timeFontSize;
-    obj["course_font_size"] = settings.courseFontSize;
-
-    // 保存时间段
-    QJsonArray timeRanges;
-    for (const TimeRange& range : settings.topmostTimeRanges) {
-        QJsonObject rangeObj;
-        rangeObj["start"] = range.start;
-        rangeObj["end"] = range.end;
-        timeRanges.append(rangeObj);
-    }
-    obj["topmost_time_ranges"] = timeRanges;
-
-    // 保存课程表
-    QJsonObject schedules;
-    for (const auto& pair : settings.schedules) {
-        QJsonArray courses;
-        for (const QString& course : pair.second) {
-            courses.append(course);
-        }
-        schedules[pair.first] = courses;
-    }
-    obj["schedules"] = schedules;
-
-    QJsonDocument doc(obj);
-
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson(QJsonDocument::Indented));
-        file.close();
-        qDebug() << "设置保存成功";
-    }
-    else {
-        qDebug() << "保存设置失败:" << file.errorString();
-        qDebug() << "错误详情:" << file.error();
-    }
-}
-
 void ClassScheduleApp::createCourseList()
 {
+    EventLoopMonitor::ActivityScope activity("createCourseList");
     qDebug() << "=== 开始创建课程列表 ===";
 
     if (!courseListLayout) {
@@ -378,53 +457,51 @@ void ClassScheduleApp::createCourseList()
         }
         delete item;
     }
+    courseLabels.clear();
     qDebug() << "清除了" << removedCount << "个旧课程项";
 
-    QStringList weekdays = { "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday" };
-    int currentDay = QDateTime::currentDateTime().date().dayOfWeek() - 1;
+    QDate today = ClockSource::instance()->currentDate();
+    int currentDay = today.dayOfWeek() - 1;
 
     qDebug() << "当前星期索引:" << currentDay;
 
-    if (currentDay < 0 || currentDay >= weekdays.size()) {
+    if (currentDay < 0 || currentDay >= ScheduleStore::kDayCount) {
         qDebug() << "错误的星期索引:" << currentDay;
         return;
     }
+    // 日历规则改用其他课表时，按星期的编辑不影响当前显示
+    displayedDay = settingsModel->calendarRuleForDate(today) ? -1 : currentDay;
 
-    QString currentWeekday = weekdays[currentDay];
-    qDebug() << "当前星期英文:" << currentWeekday;
-
-    // 检查设置中是否有该星期的课程
-    QStringList availableDays;
-    for (const auto& pair : settings.schedules) {
-        availableDays.append(pair.first);
-    }
-    qDebug() << "可用的星期:" << availableDays;
-
-    if (settings.schedules.find(currentWeekday) != settings.schedules.end()) {
-        const QStringList& courses = settings.schedules[currentWeekday];
+    if (settingsModel->hasCoursesForDate(today)) {
+        const QStringList& courses = settingsModel->coursesForDate(today);
         qDebug() << "找到课程表，课程数量:" << courses.size();
 
+        const QString style = courseLabelStyle();
+        courseLabels.assign(courses.size(), nullptr);
         for (int i = 0; i < courses.size(); i++) {
             const QString& course = courses[i];
             qDebug() << "课程" << i << ":" << course;
 
             if (!course.isEmpty()) {
                 QLabel* courseLabel = new QLabel(course, courseListWidget);
-                courseLabel->setStyleSheet(QString("font-size: %1px; font-weight: bold; color: black; background: transparent;").arg(settings.courseFontSize));
+                courseLabel->setObjectName("courseLabel");
+                courseLabel->setStyleSheet(style);
                 courseLabel->setAlignment(Qt::AlignRight);
                 courseLabel->setMinimumHeight(40); // 恢复正常高度
                 courseListLayout->addWidget(courseLabel);
+                courseLabels[i] = courseLabel;
                 qDebug() << "已创建课程标签:" << course;
             }
         }
     }
     else {
-        qDebug() << "未找到" << currentWeekday << "的课程表，使用默认课程";
+        qDebug() << "未找到" << ScheduleStore::weekdayNames()[currentDay] << "的课程表，使用默认课程";
         // 创建默认课程表
         QStringList defaultCourses = { "语文", "数学", "英语", "物理", "化学", "生物" };
         for (const QString& course : defaultCourses) {
             QLabel* courseLabel = new QLabel(course, courseListWidget);
-            courseLabel->setStyleSheet(QString("font-size: %1px; font-weight: bold; color: black; background: transparent;").arg(settings.courseFontSize));
+            courseLabel->setObjectName("courseLabel");
+            courseLabel->setStyleSheet(courseLabelStyle());
             courseLabel->setAlignment(Qt::AlignRight);
             courseLabel->setMinimumHeight(40); // 恢复正常高度
             courseListLayout->addWidget(courseLabel);
@@ -434,18 +511,25 @@ void ClassScheduleApp::createCourseList()
     // 添加弹性空间
     courseListLayout->addStretch();
     qDebug() << "=== 课程列表创建完成 ===";
+
+    emit courseListRebuilt(courseListLayout->count() - 1);
 }
 
 void ClassScheduleApp::toggleDisplayMode(bool isTopmost)
 {
+    EventLoopMonitor::ActivityScope activity("toggleDisplayMode");
     qDebug() << "切换显示模式: isTopmost =" << isTopmost;
 
+    QElapsedTimer switchTimer;
+    switchTimer.start();
+
     if (isTopmost) {
         // 置顶模式：隐藏课程表窗口，只显示时间窗口
         hide(); // 隐藏课程表窗口
 
         if (timeWindow) {
-            timeWindow->setWindowFlags(Qt::FramelessWindowHint | Qt::Tool | Qt::WindowStaysOnTopHint);
+            // 只调整层级和输入穿透，不重建原生窗口
+            timeWindow->setTopmost(true);
             // 置顶模式下透明度设为0.3，并且不可移动
             timeWindow->setTransparency(0.3);
             timeWindow->setMovable(false); // 禁用移动
@@ -465,7 +549,7 @@ void ClassScheduleApp::toggleDisplayMode(bool isTopmost)
         setWindowOpacity(settings.transparency);
 
         if (timeWindow) {
-            timeWindow->setWindowFlags(Qt::FramelessWindowHint | Qt::Tool);
+            timeWindow->setTopmost(false);
             timeWindow->setTransparency(settings.transparency); // 使用用户设置的透明度
             timeWindow->setMovable(true); // 启用移动
             timeWindow->show();
@@ -475,14 +559,29 @@ void ClassScheduleApp::toggleDisplayMode(bool isTopmost)
         currentTopmostState = false;
         qDebug() << "切换到正常模式：显示课程表窗口，透明度" << settings.transparency << "，可移动";
     }
+
+    // 切换耗时应控制在一帧之内
+    lastModeSwitchMs = switchTimer.nsecsElapsed() / 1000000.0;
+    QScreen* screen = timeWindow ? timeWindow->screen() : QApplication::primaryScreen();
+    double frameMs = (screen && screen->refreshRate() > 0) ? 1000.0 / screen->refreshRate() : 1000.0 / 60.0;
+    if (lastModeSwitchMs > frameMs) {
+        qWarning() << "显示模式切换耗时" << lastModeSwitchMs << "ms，超过一帧" << frameMs << "ms";
+    }
+    else {
+        qDebug() << "显示模式切换耗时" << lastModeSwitchMs << "ms";
+    }
+
+    emit displayModeChanged(currentTopmostState);
 }
 
 bool ClassScheduleApp::shouldBeTopmost()
 {
-    QTime currentTime = QTime::currentTime();
+    QDateTime now = ClockSource::instance()->now();
+    QTime currentTime = now.time();
     qDebug() << "当前时间:" << currentTime.toString("HH:mm:ss");
 
-    for (const TimeRange& range : settings.topmostTimeRanges) {
+    // 假期等日历规则可以取消或替换当天的置顶时间段
+    for (const TimeRange& range : settingsModel->topmostRangesForDate(now.date())) {
         QTime startTime = QTime::fromString(range.start, "HH:mm");
         QTime endTime = QTime::fromString(range.end, "HH:mm");
 
@@ -511,6 +610,13 @@ bool ClassScheduleApp::shouldBeTopmost()
 
 void ClassScheduleApp::startTimers()
 {
+    // 系统时间或时区跳变时立即重新检查星期和置顶状态
+    // （排队执行，避免在读取时间的过程中重入）
+    connect(ClockSource::instance(), &ClockSource::timeJumped, this, [this]() {
+        updateDateTime();
+        checkTopmostStatus();
+    }, Qt::QueuedConnection);
+
     // 星期检查定时器 - 用于检查星期变化并更新课程表
     datetimeTimer = new QTimer(this);
     connect(datetimeTimer, &QTimer::timeout, this, &ClassScheduleApp::updateDateTime);
@@ -533,7 +639,8 @@ void ClassScheduleApp::startTimers()
 
 void ClassScheduleApp::pixelShift()
 {
-    QScreen* screen = QApplication::primaryScreen();
+    EventLoopMonitor::ActivityScope activity("pixelShift");
+    QScreen* screen = boardScreen ? boardScreen : QApplication::primaryScreen();
     QRect screenGeometry = screen->geometry();
 
     std::random_device rd;
@@ -544,20 +651,21 @@ void ClassScheduleApp::pixelShift()
     int shiftY = dis(gen);
 
     int windowWidth = 600;
-    int newX = std::max(0, std::min(screenGeometry.width() - windowWidth,
+    int newX = screenGeometry.x() + std::max(0, std::min(screenGeometry.width() - windowWidth,
         screenGeometry.width() - windowWidth + shiftX));
-    int newY = std::max(0, std::min(0 + shiftY, 10));
+    int newY = screenGeometry.y() + std::max(0, std::min(0 + shiftY, 10));
 
     // 只有在显示状态下才移动课程表窗口
     if (isVisible()) {
         setGeometry(newX, newY, windowWidth, screenGeometry.height());
     }
 
-    // 同时移动时间窗口 - 在课程表窗口左侧100像素
-    if (timeWindow) {
-        int timeWindowX = newX - 100;
-        int timeWindowY = std::max(0, std::min(50 + shiftY, 60)); // 稍微下移
-        timeWindow->setGeometry(timeWindowX, timeWindowY, windowWidth, 150);
+    // 时间窗口围绕用户选择的位置偏移，拖动中不打断
+    if (timeWindow && !timeWindow->isDragging()) {
+        QPoint target = clockBasePosition(screenGeometry) + QPoint(shiftX, shiftY);
+        target.setX(qBound(screenGeometry.left(), target.x(), screenGeometry.right() - timeWindow->width() + 1));
+        target.setY(qBound(screenGeometry.top(), target.y(), screenGeometry.bottom() - timeWindow->height() + 1));
+        timeWindow->move(target);
     }
 
     pixelShiftCount++;
@@ -647,6 +755,7 @@ void ClassScheduleApp::setAutoStart()
 
 void ClassScheduleApp::checkTopmostStatus()
 {
+    EventLoopMonitor::ActivityScope activity("checkTopmostStatus");
     try {
         bool requireTopmost = shouldBeTopmost();
         qDebug() << "检查置顶状态: 当前状态 =" << currentTopmostState << ", 需要状态 =" << requireTopmost;
@@ -664,17 +773,17 @@ void ClassScheduleApp::checkTopmostStatus()
 
 void ClassScheduleApp::updateDateTime()
 {
-    // 这个函数现在只用于检查星期变化并更新课程表
-    QDateTime now = QDateTime::currentDateTime();
+    EventLoopMonitor::ActivityScope activity("updateDateTime");
+    // 这个函数现在只用于检查日期变化并更新课程表
+    const QDate today = ClockSource::instance()->currentDate();
 
     QStringList chineseWeekdays = { "星期一", "星期二", "星期三", "星期四", "星期五", "星期六", "星期日" };
-    int weekday = now.date().dayOfWeek() - 1;
 
-    // 检查星期变化
-    if (currentWeekday != weekday) {
-        currentWeekday = weekday;
+    // 检查日期变化：日历规则按日期生效，相邻两周的同一天课表也可能不同
+    if (currentDate != today) {
+        currentDate = today;
         createCourseList();
-        qDebug() << "星期变化，更新课程表:" << chineseWeekdays[weekday];
+        qDebug() << "日期变化，更新课程表:" << today << chineseWeekdays[today.dayOfWeek() - 1];
     }
 }
 
@@ -2,6 +2,8 @@
 #define CLASS_SCHEDULE_APP_H
 
 #include <QMainWindow>
+#include <QScreen>
+#include <QPointer>
 #include <QTimer>
 #include <QDateTime>
 #include <QSettings>
@@ -15,54 +17,87 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include "SettingsModel.h"
 #include <vector>
 #include <map>
 #include <algorithm>
 
 // 前向声明
 class TimeWindow;
-
-struct TimeRange {
-    QString start;
-    QString end;
-
-    TimeRange(const QString& s = "", const QString& e = "") : start(s), end(e) {}
-};
-
-struct ScheduleSettings {
-    double transparency = 1.0;
-    int dateFontSize = 16;
-    int timeFontSize = 48;
-    int courseFontSize = 28;
-    std::vector<TimeRange> topmostTimeRanges;
-    std::map<QString, QStringList> schedules;
+class WeekSimulator;
+class SnapshotRenderer;
+class SoakTest;
+class PaintProfiler;
+class EventLoopMonitor;
+class NoticeTicker;
+class ScheduleEditorDialog;
+class PanelScheduler;
+
+// 启动选项（模拟模式下关闭对外部环境的修改）
+struct AppOptions {
+    bool autoStart = true;        // 是否设置开机自启
+    bool persistSettings = true;  // 是否写回设置文件
+    bool profileOverlay = false;  // 启动时显示绘制分析叠加层
+    bool profilerShortcut = true; // 是否注册 Ctrl+Alt+Shift+P 应用级快捷键（多实例时只由主实例注册）
+    bool monitorEventLoop = true; // 是否启用事件循环卡顿监控
+    QString settingsPath;         // 设置文件路径，为空时使用程序目录下的 class_schedule_settings.json
 };
 
 class ClassScheduleApp : public QMainWindow
 {
     Q_OBJECT
 
+    // 模拟器、快照渲染和浸泡测试需要直接驱动内部定时器和槽函数
+    friend class WeekSimulator;
+    friend class SnapshotRenderer;
+    friend class SoakTest;
+
 public:
-    ClassScheduleApp(QWidget* parent = nullptr);
+    // model 为空时自己创建并加载设置；screen 为空时使用主屏幕
+    explicit ClassScheduleApp(const AppOptions& options = AppOptions(), SettingsModel* model = nullptr,
+        QScreen* screen = nullptr, QWidget* parent = nullptr);
     ~ClassScheduleApp();
 
+    // 移动到指定屏幕，并跟随该屏幕的分辨率/DPI 变化
+    void setBoardScreen(QScreen* screen);
+
+signals:
+    // 显示模式切换完成
+    void displayModeChanged(bool isTopmost);
+    // 课程列表重建完成
+    void courseListRebuilt(int courseCount);
+
 private slots:
+    void applySettings();
+    void applyScreenGeometry();
     void updateDateTime();
     void restartApp();
     void checkTopmostStatus();
     void updateFontSizes();
     void pixelShift();
+    void openEditor();
+
+    // 设置模型的细粒度修改，只更新受影响的部分
+    void onCourseChanged(int day, int row);
+    void onDayChanged(int day);
+    void applyCourseFontSize(int size);
+    void applyTransparency(double transparency);
+
+    // 时间窗口拖动结束，按屏幕保存位置
+    void onClockDragged(const QPoint& topLeft);
 
 private:
     void setupUI();
-    void loadSettings();
-    void saveSettings();
     void createCourseList();
+    QString courseLabelStyle() const;
+    // 时间窗口在所在屏幕上的基准位置（用户拖动后的位置或默认位置）
+    QPoint clockBasePosition(const QRect& screenGeometry) const;
+    // 把时间窗口左上角限制在屏幕范围内
+    QPoint clampClockPosition(const QRect& screenGeometry, const QPoint& position) const;
     void toggleDisplayMode(bool isTopmost);
     bool shouldBeTopmost();
     void startTimers();
     void setAutoStart();
-    void createDefaultSettings();
 
     // UI 组件
     QWidget* centralWidget;
@@ -75,11 +110,23 @@ private:
     QWidget* courseListWidget;
     QVBoxLayout* courseListLayout;
     QScrollArea* courseScrollArea;
+    std::vector<QLabel*> courseLabels; // 按课程行索引，空课程为 nullptr
+    int displayedDay;                  // 当前显示的星期下标
+
+    // 信息面板（考试倒计时、值日、下一节课），由调度器统一刷新
+    PanelScheduler* panelScheduler;
+
+    // 滚动通知栏
+    NoticeTicker* noticeTicker;
 
     // 控制按钮
+    QPushButton* editBtn;
     QPushButton* restartBtn;
     QPushButton* closeBtn;
 
+    // 课表编辑器（非模态，关闭时销毁）
+    QPointer<ScheduleEditorDialog> editorDialog;
+
     // 定时器
     QTimer* datetimeTimer;
     QTimer* topmostCheckTimer;
@@ -88,11 +135,26 @@ private:
     // 时间窗口
     TimeWindow* timeWindow;
 
+    // 绘制分析（Ctrl+Alt+Shift+P 切换）
+    PaintProfiler* paintProfiler;
+
+    // 事件循环卡顿监控
+    EventLoopMonitor* eventLoopMonitor;
+
     // 应用状态
-    ScheduleSettings settings;
+    AppOptions options;
+    SettingsModel* settingsModel;
+    bool ownsSettingsModel;
+    const ScheduleSettings& settings; // 共享设置模型中的设置
+
+    // 所在屏幕（屏幕被拔掉后自动置空）
+    QPointer<QScreen> boardScreen;
+    std::vector<QMetaObject::Connection> screenConnections;
+
     bool currentTopmostState;
-    int currentWeekday;
+    QDate currentDate; // 课程表对应的日期（日历规则按日期而非星期生效）
     int pixelShiftCount;
+    double lastModeSwitchMs; // 最近一次模式切换耗时
     const int maxPixelShift = 3;
 };
 
@@ -0,0 +1,165 @@
+﻿#define NOMINMAX
+#include "ClockSource.h"
+#include <QCoreApplication>
+#include <QAbstractNativeEventFilter>
+#include <QTimeZone>
+#include <QDebug>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+ClockSource* g_injectedClock = nullptr;
+
+// 定期重新对齐单调时钟和系统时间，消除长时间运行的漂移
+const qint64 kResyncIntervalMs = 60 * 60 * 1000;
+// 重新对齐时偏差超过该值视为系统时间被修改
+const qint64 kJumpThresholdMs = 2000;
+}
+
+ClockSource* ClockSource::instance()
+{
+    if (g_injectedClock) {
+        return g_injectedClock;
+    }
+
+    static SystemClock systemClock;
+    return &systemClock;
+}
+
+void ClockSource::setInstance(ClockSource* source)
+{
+    g_injectedClock = source;
+}
+
+// 监听系统的时间/时区变化和休眠恢复通知（Windows 下为 WM_TIMECHANGE、WM_POWERBROADCAST）
+class SystemClock::NativeTimeChangeFilter : public QAbstractNativeEventFilter
+{
+public:
+    explicit NativeTimeChangeFilter(SystemClock* clock) : m_clock(clock) {}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    bool nativeEventFilter(const QByteArray& eventType, void* message, qintptr* result) override
+#else
+    bool nativeEventFilter(const QByteArray& eventType, void* message, long* result) override
+#endif
+    {
+        Q_UNUSED(result);
+#ifdef Q_OS_WIN
+        if (eventType == "windows_generic_MSG") {
+            const MSG* msg = static_cast<const MSG*>(message);
+            if (msg->message == WM_TIMECHANGE) {
+                m_clock->invalidate();
+            }
+            else if (msg->message == WM_POWERBROADCAST
+                && (msg->wParam == PBT_APMRESUMEAUTOMATIC || msg->wParam == PBT_APMRESUMESUSPEND)) {
+                // 从睡眠/休眠恢复
+                m_clock->invalidate();
+            }
+        }
+#else
+        Q_UNUSED(eventType);
+        Q_UNUSED(message);
+#endif
+        return false;
+    }
+
+private:
+    SystemClock* m_clock;
+};
+
+SystemClock::SystemClock(QObject* parent)
+    : ClockSource(parent),
+    m_baseUtcMs(0), m_offsetSeconds(0), m_validUntilUtcMs(0), m_valid(false),
+    m_nativeFilter(nullptr)
+{
+    if (QCoreApplication::instance()) {
+        m_nativeFilter = new NativeTimeChangeFilter(this);
+        QCoreApplication::instance()->installNativeEventFilter(m_nativeFilter);
+    }
+}
+
+SystemClock::~SystemClock()
+{
+    if (m_nativeFilter && QCoreApplication::instance()) {
+        QCoreApplication::instance()->removeNativeEventFilter(m_nativeFilter);
+    }
+    delete m_nativeFilter;
+}
+
+QDateTime SystemClock::now() const
+{
+    // 休眠唤醒后单调时钟可能与系统时间脱节，每次读取时用 UTC 时间校验一次
+    // （只是读取系统时间，不做时区转换）
+    if (!m_valid || m_baseUtcMs + m_monotonic.elapsed() >= m_validUntilUtcMs
+        || std::abs(QDateTime::currentMSecsSinceEpoch() - (m_baseUtcMs + m_monotonic.elapsed())) > kJumpThresholdMs) {
+        // 读取时间的接口是 const 的，缓存刷新属于内部状态
+        const_cast<SystemClock*>(this)->resync();
+    }
+    const qint64 utcMs = m_baseUtcMs + m_monotonic.elapsed();
+
+    // 固定偏移的 QDateTime 不需要再查询时区数据库
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    return QDateTime::fromMSecsSinceEpoch(utcMs, QTimeZone::fromSecondsAheadOfUtc(m_offsetSeconds));
+#else
+    return QDateTime::fromMSecsSinceEpoch(utcMs, Qt::OffsetFromUTC, m_offsetSeconds);
+#endif
+}
+
+void SystemClock::invalidate()
+{
+    qDebug() << "系统时间或时区已变化，重新同步时钟";
+    m_valid = false;
+}
+
+void SystemClock::resync()
+{
+    const bool firstSync = !m_monotonic.isValid();
+    const bool notified = !firstSync && !m_valid;
+    const qint64 predictedUtcMs = firstSync ? 0 : m_baseUtcMs + m_monotonic.elapsed();
+    const int previousOffset = m_offsetSeconds;
+
+    // 这里是唯一做时区转换的地方
+    const QDateTime local = QDateTime::currentDateTime();
+    m_monotonic.start();
+    m_baseUtcMs = local.toMSecsSinceEpoch();
+    m_offsetSeconds = local.offsetFromUtc();
+    m_validUntilUtcMs = m_baseUtcMs + kResyncIntervalMs;
+    m_valid = true;
+
+    const QTimeZone zone = QTimeZone::systemTimeZone();
+    if (zone.hasTransitions()) {
+        const QTimeZone::OffsetData next = zone.nextTransition(local);
+        if (next.atUtc.isValid()) {
+            m_validUntilUtcMs = std::min(m_validUntilUtcMs, next.atUtc.toMSecsSinceEpoch());
+        }
+    }
+
+    qDebug() << "时钟已同步，UTC 偏移" << m_offsetSeconds << "秒，下次同步"
+        << QDateTime::fromMSecsSinceEpoch(m_validUntilUtcMs).toString("yyyy-MM-dd HH:mm:ss");
+
+    // 系统通知、夏令时切换或与推算值偏差较大，说明本地时间发生了跳变
+    if (!firstSync && (notified || previousOffset != m_offsetSeconds
+        || std::abs(predictedUtcMs - m_baseUtcMs) > kJumpThresholdMs)) {
+        emit timeJumped();
+    }
+}
+
+VirtualClock::VirtualClock(const QDateTime& start, QObject* parent)
+    : ClockSource(parent), m_now(start)
+{
+}
+
+void VirtualClock::setDateTime(const QDateTime& dateTime)
+{
+    m_now = dateTime;
+    emit timeJumped();
+}
+
+void VirtualClock::advance(qint64 msecs)
+{
+    m_now = m_now.addMSecs(msecs);
+}
@@ -0,0 +1,88 @@
+﻿#ifndef CLOCK_SOURCE_H
+#define CLOCK_SOURCE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QDate>
+#include <QTime>
+#include <QElapsedTimer>
+
+// 时钟源：所有读取当前时间的地方都通过 ClockSource::instance() 获取，
+// 这样可以在模拟/测试时注入虚拟时钟，而不依赖真实的系统时间
+class ClockSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClockSource(QObject* parent = nullptr) : QObject(parent) {}
+    ~ClockSource() override = default;
+
+    // 当前使用的时钟源（默认为系统时钟）
+    static ClockSource* instance();
+
+    // 注入时钟源，传入 nullptr 恢复系统时钟
+    static void setInstance(ClockSource* source);
+
+    virtual QDateTime now() const = 0;
+
+    // 是否为虚拟时钟（模拟模式下不应写注册表等外部状态）
+    virtual bool isVirtual() const { return false; }
+
+    QTime currentTime() const { return now().time(); }
+    QDate currentDate() const { return now().date(); }
+
+signals:
+    // 时间发生跳变（虚拟时钟被直接设置）
+    void timeJumped();
+};
+
+// 系统时钟：缓存当前 UTC 偏移，由单调时钟推算本地时间，
+// 每秒读取时不做时区转换。只在到达下一次夏令时切换、
+// 系统通知时间/时区变化、休眠恢复、推算值与系统 UTC 时间偏差过大
+// 或定期校准时重新查询时区。
+class SystemClock : public ClockSource
+{
+    Q_OBJECT
+
+public:
+    explicit SystemClock(QObject* parent = nullptr);
+    ~SystemClock() override;
+
+    QDateTime now() const override;
+
+public slots:
+    // 系统时间或时区发生变化，下一次读取时重新同步
+    void invalidate();
+
+private:
+    void resync();
+
+    QElapsedTimer m_monotonic;  // 单调时钟，从基准时刻开始计时
+    qint64 m_baseUtcMs;         // 基准时刻的 UTC 毫秒数
+    int m_offsetSeconds;        // 当前本地时间相对 UTC 的偏移
+    qint64 m_validUntilUtcMs;   // 偏移有效期（下一次夏令时切换或定期校准）
+    bool m_valid;
+
+    class NativeTimeChangeFilter;
+    NativeTimeChangeFilter* m_nativeFilter;
+};
+
+// 虚拟时钟：时间只在调用 setDateTime/advance 时前进
+class VirtualClock : public ClockSource
+{
+    Q_OBJECT
+
+public:
+    explicit VirtualClock(const QDateTime& start, QObject* parent = nullptr);
+
+    QDateTime now() const override { return m_now; }
+    bool isVirtual() const override { return true; }
+
+    void setDateTime(const QDateTime& dateTime);
+    void advance(qint64 msecs);
+
+private:
+    QDateTime m_now;
+};
+
+#endif // CLOCK_SOURCE_H
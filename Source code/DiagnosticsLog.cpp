@@ -0,0 +1,54 @@
+﻿#include "DiagnosticsLog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+DiagnosticsLog& DiagnosticsLog::instance()
+{
+    static DiagnosticsLog log(QCoreApplication::applicationDirPath() + "/diagnostics.log",
+        1024 * 1024, 3);
+    return log;
+}
+
+DiagnosticsLog::DiagnosticsLog(const QString& path, qint64 maxBytes, int maxFiles)
+    : m_path(path), m_maxBytes(maxBytes), m_maxFiles(maxFiles)
+{
+}
+
+void DiagnosticsLog::write(const QString& category, const QString& message)
+{
+    // 诊断记录使用真实时间，不受虚拟时钟影响
+    const QByteArray line = QString("%1 [%2] %3\n")
+        .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz"), category, message)
+        .toUtf8();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    rotateIfNeeded(line.size());
+
+    // 每次追加后立即关闭，程序异常退出时也不会丢失已写入的记录
+    QFile file(m_path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        file.write(line);
+        file.close();
+    }
+    else {
+        qDebug() << "写入诊断日志失败:" << file.errorString();
+    }
+}
+
+void DiagnosticsLog::rotateIfNeeded(qint64 incomingBytes)
+{
+    QFileInfo info(m_path);
+    if (!info.exists() || info.size() + incomingBytes <= m_maxBytes) {
+        return;
+    }
+
+    // diagnostics.log.N-1 -> .N ... diagnostics.log -> .1
+    QFile::remove(QString("%1.%2").arg(m_path).arg(m_maxFiles));
+    for (int i = m_maxFiles - 1; i >= 1; i--) {
+        QFile::rename(QString("%1.%2").arg(m_path).arg(i), QString("%1.%2").arg(m_path).arg(i + 1));
+    }
+    QFile::rename(m_path, m_path + ".1");
+}
@@ -0,0 +1,29 @@
+﻿#ifndef DIAGNOSTICS_LOG_H
+#define DIAGNOSTICS_LOG_H
+
+#include <QString>
+#include <mutex>
+
+// 现场诊断日志：写入程序目录下的 diagnostics.log，超过大小上限时轮转
+// （diagnostics.log.1 ... .N）。可以从任意线程调用。
+class DiagnosticsLog
+{
+public:
+    static DiagnosticsLog& instance();
+
+    DiagnosticsLog(const QString& path, qint64 maxBytes, int maxFiles);
+
+    void write(const QString& category, const QString& message);
+
+    QString path() const { return m_path; }
+
+private:
+    void rotateIfNeeded(qint64 incomingBytes);
+
+    QString m_path;
+    qint64 m_maxBytes;
+    int m_maxFiles;
+    std::mutex m_mutex;
+};
+
+#endif // DIAGNOSTICS_LOG_H
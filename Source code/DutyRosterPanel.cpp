@@ -0,0 +1,24 @@
+﻿#include "DutyRosterPanel.h"
+#include "SettingsModel.h"
+
+DutyRosterPanel::DutyRosterPanel(SettingsModel* model, QWidget* parent)
+    : InfoPanel(model, parent)
+{
+    setObjectName("dutyRosterPanel");
+}
+
+bool DutyRosterPanel::isConfigured() const
+{
+    for (const QString& duty : m_model->settings().dutyRoster) {
+        if (!duty.isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DutyRosterPanel::refresh(const QDateTime& now)
+{
+    const QString duty = m_model->settings().dutyRoster.value(now.date().dayOfWeek() - 1);
+    setText("今日值日", duty.isEmpty() ? QString("无") : duty);
+}
@@ -0,0 +1,20 @@
+﻿#ifndef DUTY_ROSTER_PANEL_H
+#define DUTY_ROSTER_PANEL_H
+
+#include "InfoPanel.h"
+
+// 今日值日（duty_roster，按星期配置）
+class DutyRosterPanel : public InfoPanel
+{
+    Q_OBJECT
+
+public:
+    explicit DutyRosterPanel(SettingsModel* model, QWidget* parent = nullptr);
+
+    QString panelName() const override { return "DutyRoster"; }
+    int updateIntervalMs() const override { return 60000; }
+    bool isConfigured() const override;
+    void refresh(const QDateTime& now) override;
+};
+
+#endif // DUTY_ROSTER_PANEL_H
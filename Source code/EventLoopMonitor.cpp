@@ -0,0 +1,178 @@
+﻿#include "EventLoopMonitor.h"
+#include "DiagnosticsLog.h"
+#include <QStringList>
+#include <QDebug>
+#include <chrono>
+
+namespace {
+// 直方图桶的上界（毫秒），最后一个桶为 ">2000"
+const qint64 kBucketLimits[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000 };
+}
+
+std::atomic<const char*> EventLoopMonitor::s_activityName(nullptr);
+std::atomic<qint64> EventLoopMonitor::s_activityStartMs(0);
+
+EventLoopMonitor::ActivityScope::ActivityScope(const char* name)
+    : m_previousName(s_activityName.load(std::memory_order_relaxed)),
+    m_previousStartMs(s_activityStartMs.load(std::memory_order_relaxed))
+{
+    s_activityStartMs.store(monotonicMs(), std::memory_order_relaxed);
+    s_activityName.store(name, std::memory_order_release);
+}
+
+EventLoopMonitor::ActivityScope::~ActivityScope()
+{
+    s_activityStartMs.store(m_previousStartMs, std::memory_order_relaxed);
+    s_activityName.store(m_previousName, std::memory_order_release);
+}
+
+EventLoopMonitor::EventLoopMonitor(int stallThresholdMs, QObject* parent)
+    : QObject(parent),
+    m_heartbeatTimer(nullptr), m_stallThresholdMs(qMax(kHeartbeatIntervalMs, stallThresholdMs)),
+    m_maxLatencyMs(0), m_lastSummaryMs(0),
+    m_lastBeatMs(0), m_stallReported(false), m_running(false)
+{
+    m_histogram.fill(0);
+
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setTimerType(Qt::PreciseTimer);
+    m_heartbeatTimer->setInterval(kHeartbeatIntervalMs);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &EventLoopMonitor::heartbeat);
+}
+
+EventLoopMonitor::~EventLoopMonitor()
+{
+    stop();
+}
+
+qint64 EventLoopMonitor::monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void EventLoopMonitor::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_lastBeatMs = monotonicMs();
+    m_lastSummaryMs = m_lastBeatMs;
+    m_running = true;
+    m_heartbeatTimer->start();
+    m_watchdog = std::thread(&EventLoopMonitor::watchdogLoop, this);
+
+    DiagnosticsLog::instance().write("monitor", QString("事件循环监控已启动，卡顿阈值 %1ms").arg(m_stallThresholdMs));
+}
+
+void EventLoopMonitor::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_heartbeatTimer->stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if (m_watchdog.joinable()) {
+        m_watchdog.join();
+    }
+
+    writeSummary();
+}
+
+int EventLoopMonitor::bucketFor(qint64 latencyMs)
+{
+    for (int i = 0; i < kBucketCount - 1; i++) {
+        if (latencyMs < kBucketLimits[i]) {
+            return i;
+        }
+    }
+    return kBucketCount - 1;
+}
+
+void EventLoopMonitor::heartbeat()
+{
+    const qint64 now = monotonicMs();
+    const qint64 latency = qMax<qint64>(0, now - m_lastBeatMs.load() - kHeartbeatIntervalMs);
+    m_lastBeatMs = now;
+
+    m_histogram[bucketFor(latency)]++;
+    m_maxLatencyMs = qMax(m_maxLatencyMs, latency);
+
+    if (latency >= m_stallThresholdMs) {
+        QString activity;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            activity = m_stallActivity;
+            m_stallActivity.clear();
+        }
+        DiagnosticsLog::instance().write("stall", QString("事件循环卡顿 %1ms，卡顿期间执行: %2")
+            .arg(latency).arg(activity.isEmpty() ? QString("未知") : activity));
+        qWarning() << "事件循环卡顿" << latency << "ms" << activity;
+    }
+    m_stallReported = false;
+
+    if (now - m_lastSummaryMs >= kSummaryIntervalMs) {
+        writeSummary();
+        m_lastSummaryMs = now;
+    }
+}
+
+void EventLoopMonitor::watchdogLoop()
+{
+    const auto pollInterval = std::chrono::milliseconds(qMax(25, m_stallThresholdMs / 4));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        m_wake.wait_for(lock, pollInterval);
+        if (!m_running) {
+            break;
+        }
+
+        const qint64 now = monotonicMs();
+        const qint64 sinceBeat = now - m_lastBeatMs.load() - kHeartbeatIntervalMs;
+        if (sinceBeat < m_stallThresholdMs || m_stallReported) {
+            continue;
+        }
+
+        // GUI 线程已超过阈值没有响应，记录此刻正在执行的操作
+        const char* name = s_activityName.load(std::memory_order_acquire);
+        const qint64 activityMs = now - s_activityStartMs.load(std::memory_order_relaxed);
+        m_stallActivity = name
+            ? QString("%1 (已运行 %2ms)").arg(QString::fromLatin1(name)).arg(activityMs)
+            : QString("事件分发/重绘");
+        m_stallReported = true;
+
+        const QString message = QString("事件循环已 %1ms 无响应，当前执行: %2").arg(sinceBeat).arg(m_stallActivity);
+        lock.unlock();
+        DiagnosticsLog::instance().write("watchdog", message);
+        lock.lock();
+    }
+}
+
+void EventLoopMonitor::writeSummary()
+{
+    QStringList buckets;
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        total += m_histogram[i];
+        const QString label = i < kBucketCount - 1
+            ? QString("<%1").arg(kBucketLimits[i])
+            : QString(">=%1").arg(kBucketLimits[kBucketCount - 2]);
+        buckets.append(QString("%1:%2").arg(label).arg(m_histogram[i]));
+    }
+    if (total == 0) {
+        return;
+    }
+
+    DiagnosticsLog::instance().write("latency", QString("心跳 %1 次，最大延迟 %2ms，分布(ms) %3")
+        .arg(total).arg(m_maxLatencyMs).arg(buckets.join(' ')));
+
+    m_histogram.fill(0);
+    m_maxLatencyMs = 0;
+}
@@ -0,0 +1,78 @@
+﻿#ifndef EVENT_LOOP_MONITOR_H
+#define EVENT_LOOP_MONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// 事件循环延迟监控：GUI 线程上的心跳定时器持续测量事件分发延迟并统计直方图；
+// 辅助线程作为看门狗，心跳超过阈值未到时记录当前正在执行的定时器/槽函数。
+// 结果写入 DiagnosticsLog。
+class EventLoopMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 标记当前正在执行的操作（定时器回调、槽函数等），可嵌套
+    class ActivityScope
+    {
+    public:
+        explicit ActivityScope(const char* name);
+        ~ActivityScope();
+
+        ActivityScope(const ActivityScope&) = delete;
+        ActivityScope& operator=(const ActivityScope&) = delete;
+
+    private:
+        const char* m_previousName;
+        qint64 m_previousStartMs;
+    };
+
+    explicit EventLoopMonitor(int stallThresholdMs, QObject* parent = nullptr);
+    ~EventLoopMonitor() override;
+
+    void start();
+    void stop();
+
+    // 单调时钟（毫秒），各线程共用
+    static qint64 monotonicMs();
+
+private slots:
+    void heartbeat();
+
+private:
+    static constexpr int kHeartbeatIntervalMs = 100;
+    static constexpr int kSummaryIntervalMs = 10 * 60 * 1000;
+    static constexpr int kBucketCount = 12;
+
+    static int bucketFor(qint64 latencyMs);
+    void watchdogLoop();
+    void writeSummary();
+
+    // 当前活动（字符串字面量）及其开始时间
+    static std::atomic<const char*> s_activityName;
+    static std::atomic<qint64> s_activityStartMs;
+
+    QTimer* m_heartbeatTimer;
+    int m_stallThresholdMs;
+
+    // GUI 线程统计
+    std::array<quint64, kBucketCount> m_histogram;
+    qint64 m_maxLatencyMs;
+    qint64 m_lastSummaryMs;
+
+    // 看门狗线程
+    std::atomic<qint64> m_lastBeatMs;
+    std::atomic<bool> m_stallReported;
+    std::atomic<bool> m_running;
+    std::thread m_watchdog;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    QString m_stallActivity; // 看门狗记录的卡顿活动，受 m_mutex 保护
+};
+
+#endif // EVENT_LOOP_MONITOR_H
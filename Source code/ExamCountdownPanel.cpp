@@ -0,0 +1,30 @@
+﻿#include "ExamCountdownPanel.h"
+#include "SettingsModel.h"
+
+ExamCountdownPanel::ExamCountdownPanel(SettingsModel* model, QWidget* parent)
+    : InfoPanel(model, parent)
+{
+    setObjectName("examCountdownPanel");
+}
+
+bool ExamCountdownPanel::isConfigured() const
+{
+    return m_model->settings().examDate.isValid();
+}
+
+void ExamCountdownPanel::refresh(const QDateTime& now)
+{
+    const ScheduleSettings& settings = m_model->settings();
+    const qint64 days = now.date().daysTo(settings.examDate);
+    const QString name = settings.examName.isEmpty() ? QString("考试") : settings.examName;
+
+    if (days > 0) {
+        setText(QString("距离%1").arg(name), QString("还有 %1 天").arg(days));
+    }
+    else if (days == 0) {
+        setText(name, "就在今天");
+    }
+    else {
+        setText(name, "已结束");
+    }
+}
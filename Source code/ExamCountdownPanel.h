@@ -0,0 +1,20 @@
+﻿#ifndef EXAM_COUNTDOWN_PANEL_H
+#define EXAM_COUNTDOWN_PANEL_H
+
+#include "InfoPanel.h"
+
+// 考试倒计时（exam_name / exam_date），内容按天变化
+class ExamCountdownPanel : public InfoPanel
+{
+    Q_OBJECT
+
+public:
+    explicit ExamCountdownPanel(SettingsModel* model, QWidget* parent = nullptr);
+
+    QString panelName() const override { return "ExamCountdown"; }
+    int updateIntervalMs() const override { return 60000; }
+    bool isConfigured() const override;
+    void refresh(const QDateTime& now) override;
+};
+
+#endif // EXAM_COUNTDOWN_PANEL_H
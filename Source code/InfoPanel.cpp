@@ -0,0 +1,61 @@
+﻿#include "InfoPanel.h"
+#include "SettingsModel.h"
+#include <QElapsedTimer>
+#include <QPainter>
+
+InfoPanel::InfoPanel(SettingsModel* model, QWidget* parent)
+    : QWidget(parent),
+    m_model(model)
+{
+    setAttribute(Qt::WA_TranslucentBackground);
+    applyFontSize();
+}
+
+void InfoPanel::applyFontSize()
+{
+    // 标题行 24 像素，内容行按课程字体大小留出行距
+    setFixedHeight(24 + m_model->settings().courseFontSize + 16);
+    update();
+}
+
+void InfoPanel::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QElapsedTimer timer;
+    timer.start();
+
+    QPainter painter(this);
+    paintPanel(painter);
+    painter.end();
+
+    emit painted(timer.nsecsElapsed() / 1000000.0);
+}
+
+void InfoPanel::paintPanel(QPainter& painter)
+{
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setPen(Qt::black);
+
+    QFont titleFont = font();
+    titleFont.setPixelSize(16);
+    painter.setFont(titleFont);
+    QRect titleRect(0, 0, width(), 24);
+    painter.drawText(titleRect, Qt::AlignRight | Qt::AlignVCenter, m_title);
+
+    QFont valueFont = font();
+    valueFont.setPixelSize(m_model->settings().courseFontSize);
+    valueFont.setBold(true);
+    painter.setFont(valueFont);
+    QRect valueRect(0, titleRect.bottom() + 1, width(), height() - titleRect.height());
+    painter.drawText(valueRect, Qt::AlignRight | Qt::AlignTop, m_value);
+}
+
+void InfoPanel::setText(const QString& title, const QString& value)
+{
+    if (title == m_title && value == m_value) {
+        return;
+    }
+    m_title = title;
+    m_value = value;
+    update();
+}
@@ -0,0 +1,54 @@
+﻿#ifndef INFO_PANEL_H
+#define INFO_PANEL_H
+
+#include <QWidget>
+#include <QDateTime>
+#include <QString>
+
+class SettingsModel;
+
+// 信息面板基类：课程列表旁的考试倒计时、值日、下一节课等小面板。
+// 每个面板声明自己的刷新间隔和绘制预算，由 PanelScheduler 统一驱动；
+// 默认绘制为一行标题加一行内容，内容不变时不触发重绘。
+class InfoPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    InfoPanel(SettingsModel* model, QWidget* parent = nullptr);
+
+    // 面板名称（用于诊断日志）
+    virtual QString panelName() const = 0;
+    // 需要的刷新间隔（毫秒）
+    virtual int updateIntervalMs() const = 0;
+    // 单次刷新加绘制的耗时上限（毫秒）
+    virtual double budgetMs() const { return 4.0; }
+    // 设置中是否配置了该面板，未配置时隐藏
+    virtual bool isConfigured() const = 0;
+
+    // 按当前时间更新内容
+    virtual void refresh(const QDateTime& now) = 0;
+
+    // 按课程字体大小调整面板高度
+    void applyFontSize();
+
+signals:
+    // 一次绘制完成及其耗时
+    void painted(double ms);
+
+protected:
+    void paintEvent(QPaintEvent* event) final;
+    // 子类可以自行绘制，默认绘制标题和内容
+    virtual void paintPanel(QPainter& painter);
+
+    // 更新显示的文字，没有变化时不重绘
+    void setText(const QString& title, const QString& value);
+
+    SettingsModel* m_model;
+
+private:
+    QString m_title;
+    QString m_value;
+};
+
+#endif // INFO_PANEL_H
@@ -0,0 +1,37 @@
+﻿#include "NextPeriodPanel.h"
+#include "SettingsModel.h"
+
+NextPeriodPanel::NextPeriodPanel(SettingsModel* model, QWidget* parent)
+    : InfoPanel(model, parent)
+{
+    setObjectName("nextPeriodPanel");
+}
+
+bool NextPeriodPanel::isConfigured() const
+{
+    return !m_model->settings().periodTimes.empty();
+}
+
+void NextPeriodPanel::refresh(const QDateTime& now)
+{
+    const std::vector<TimeRange>& periods = m_model->settings().periodTimes;
+    const QStringList& courses = m_model->coursesForDate(now.date());
+    const QString time = now.time().toString("HH:mm");
+    const int count = qMin(int(periods.size()), int(courses.size()));
+
+    // HH:mm 字符串可以直接按字典序比较
+    for (int i = 0; i < count; i++) {
+        if (courses[i].isEmpty()) {
+            continue;
+        }
+        if (periods[i].start <= time && time < periods[i].end) {
+            setText(QString("本节 %1-%2").arg(periods[i].start, periods[i].end), courses[i]);
+            return;
+        }
+        if (time < periods[i].start) {
+            setText(QString("下一节 %1").arg(periods[i].start), courses[i]);
+            return;
+        }
+    }
+    setText("下一节", "今日课程已结束");
+}
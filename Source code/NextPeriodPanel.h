@@ -0,0 +1,21 @@
+﻿#ifndef NEXT_PERIOD_PANEL_H
+#define NEXT_PERIOD_PANEL_H
+
+#include "InfoPanel.h"
+
+// 下一节课预告：按 period_times 中与课程行对应的上下课时间，
+// 显示当前或下一节课及开始时间
+class NextPeriodPanel : public InfoPanel
+{
+    Q_OBJECT
+
+public:
+    explicit NextPeriodPanel(SettingsModel* model, QWidget* parent = nullptr);
+
+    QString panelName() const override { return "NextPeriod"; }
+    int updateIntervalMs() const override { return 15000; }
+    bool isConfigured() const override;
+    void refresh(const QDateTime& now) override;
+};
+
+#endif // NEXT_PERIOD_PANEL_H
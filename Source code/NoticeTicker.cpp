@@ -0,0 +1,228 @@
+﻿#include "NoticeTicker.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScreen>
+#include <QTextStream>
+#include <QDebug>
+
+namespace {
+const int kMessageGap = 80;          // 两条通知之间的间隔（像素）
+const int kReloadDelayMs = 200;      // 文件变化后的合并延迟
+const QColor kBackground(255, 248, 220);
+}
+
+NoticeTicker::NoticeTicker(const QString& filePath, int fontSize, int pixelsPerSecond, QWidget* parent)
+    : QWidget(parent),
+    m_filePath(filePath), m_fontSize(fontSize), m_pixelsPerSecond(qMax(1, pixelsPerSecond)),
+    m_watcher(nullptr), m_reloadTimer(nullptr), m_frameTimer(nullptr),
+    m_cycleWidth(0), m_offset(0)
+{
+    // 不透明绘制，scroll() 才能直接移动已有像素
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    QFont tickerFont = font();
+    tickerFont.setPixelSize(m_fontSize);
+    tickerFont.setBold(true);
+    setFont(tickerFont);
+    setFixedHeight(QFontMetrics(tickerFont).height() + 12);
+
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(kReloadDelayMs);
+    connect(m_reloadTimer, &QTimer::timeout, this, &NoticeTicker::reload);
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &NoticeTicker::advanceFrame);
+
+    // 同时监视文件和所在目录，编辑器先删除再写入时也能收到通知
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(QFileInfo(m_filePath).absolutePath());
+    if (QFileInfo::exists(m_filePath)) {
+        m_watcher->addPath(m_filePath);
+    }
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &NoticeTicker::scheduleReload);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &NoticeTicker::scheduleReload);
+
+    // 没有通知时不占用布局空间
+    hide();
+    reload();
+}
+
+void NoticeTicker::scheduleReload()
+{
+    m_reloadTimer->start();
+}
+
+QStringList NoticeTicker::readMessages() const
+{
+    QStringList messages;
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return messages;
+    }
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    if (m_filePath.endsWith(".json", Qt::CaseInsensitive)) {
+        // ["...", "..."] 或 {"messages": ["...", "..."]}
+        QJsonDocument doc = QJsonDocument::fromJson(data);
+        const QJsonArray array = doc.isArray() ? doc.array() : doc.object().value("messages").toArray();
+        for (const QJsonValue& value : array) {
+            messages.append(value.toString());
+        }
+    }
+    else {
+        QTextStream in(data);
+        while (!in.atEnd()) {
+            messages.append(in.readLine());
+        }
+    }
+
+    for (QString& message : messages) {
+        message = message.trimmed();
+    }
+    messages.removeAll(QString());
+    return messages;
+}
+
+void NoticeTicker::reload()
+{
+    // 文件被重新创建后需要重新加入监视
+    if (QFileInfo::exists(m_filePath) && !m_watcher->files().contains(m_filePath)) {
+        m_watcher->addPath(m_filePath);
+    }
+
+    const QStringList messages = readMessages();
+    if (messages == m_messages) {
+        return;
+    }
+
+    m_messages = messages;
+    qDebug() << "通知已更新，条数:" << m_messages.size();
+
+    rasterize();
+    m_offset = 0;
+    m_clock.start();
+    setVisible(!m_messages.isEmpty());
+    updateAnimationState();
+    update();
+}
+
+void NoticeTicker::rasterize()
+{
+    m_pixmaps.clear();
+    m_cycleWidth = 0;
+
+    const qreal dpr = devicePixelRatioF();
+    const QFontMetrics metrics(font());
+    for (const QString& message : m_messages) {
+        const QSize size(metrics.horizontalAdvance(message) + 2, metrics.height());
+        QPixmap pixmap(size * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(kBackground);
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        painter.setFont(font());
+        painter.setPen(QColor(160, 40, 0));
+        painter.drawText(QRect(QPoint(0, 0), size), Qt::AlignLeft | Qt::AlignVCenter, message);
+        painter.end();
+
+        m_pixmaps.push_back(pixmap);
+        m_cycleWidth += size.width() + kMessageGap;
+    }
+}
+
+void NoticeTicker::advanceFrame()
+{
+    if (m_cycleWidth <= 0) {
+        return;
+    }
+
+    const int offset = int((m_clock.elapsed() * m_pixelsPerSecond / 1000) % m_cycleWidth);
+    int dx = offset - m_offset;
+    if (dx == 0) {
+        return;
+    }
+    if (dx < 0) {
+        dx += m_cycleWidth; // 回绕
+    }
+    m_offset = offset;
+
+    if (dx >= width()) {
+        update();
+    }
+    else {
+        // 移动已有像素，只重绘右侧新露出的部分
+        scroll(-dx, 0);
+    }
+}
+
+void NoticeTicker::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, kBackground);
+
+    if (m_pixmaps.empty()) {
+        return;
+    }
+
+    const int y = (height() - QFontMetrics(font()).height()) / 2;
+
+    // 从当前偏移开始平铺，直到填满脏区域
+    int x = -m_offset;
+    while (x < dirty.right() + 1) {
+        for (const QPixmap& pixmap : m_pixmaps) {
+            const int w = int(pixmap.width() / pixmap.devicePixelRatio());
+            if (x + w > dirty.left() && x <= dirty.right()) {
+                painter.drawPixmap(x, y, pixmap);
+            }
+            x += w + kMessageGap;
+            if (x > dirty.right()) {
+                break;
+            }
+        }
+    }
+}
+
+void NoticeTicker::updateAnimationState()
+{
+    if (isVisible() && m_cycleWidth > 0) {
+        QScreen* currentScreen = screen();
+        const qreal refreshRate = (currentScreen && currentScreen->refreshRate() > 0) ? currentScreen->refreshRate() : 60.0;
+        m_frameTimer->start(qMax(1, int(1000.0 / refreshRate)));
+    }
+    else {
+        m_frameTimer->stop();
+    }
+}
+
+void NoticeTicker::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    updateAnimationState();
+}
+
+void NoticeTicker::hideEvent(QHideEvent* event)
+{
+    // 课程表窗口隐藏（置顶模式）时停止滚动，不占用 CPU
+    QWidget::hideEvent(event);
+    m_frameTimer->stop();
+}
+
+void NoticeTicker::changeEvent(QEvent* event)
+{
+    QWidget::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        rasterize();
+        update();
+    }
+}
@@ -0,0 +1,57 @@
+﻿#ifndef NOTICE_TICKER_H
+#define NOTICE_TICKER_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QPixmap>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QStringList>
+#include <vector>
+
+// 滚动通知栏：从本地 txt（每行一条）或 json（字符串数组）读取通知并监视文件变化。
+// 每条通知只栅格化一次到缓存位图，每帧只按偏移量滚动，
+// 控件为不透明绘制，scroll() 只需重绘新露出的窄条。
+class NoticeTicker : public QWidget
+{
+    Q_OBJECT
+
+public:
+    NoticeTicker(const QString& filePath, int fontSize, int pixelsPerSecond, QWidget* parent = nullptr);
+
+    // 当前通知条数
+    int messageCount() const { return m_messages.size(); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void scheduleReload();
+    void reload();
+    void advanceFrame();
+
+private:
+    QStringList readMessages() const;
+    void rasterize();
+    void updateAnimationState();
+
+    QString m_filePath;
+    int m_fontSize;
+    int m_pixelsPerSecond;
+
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_reloadTimer;   // 合并短时间内的多次文件变化
+    QTimer* m_frameTimer;    // 按屏幕刷新率推进滚动
+
+    QStringList m_messages;
+    std::vector<QPixmap> m_pixmaps; // 每条通知的缓存位图
+    int m_cycleWidth;               // 所有通知加间隔的总宽度
+
+    QElapsedTimer m_clock;   // 滚动位置按真实经过时间计算，掉帧不会变慢
+    int m_offset;            // 当前滚动偏移（像素）
+};
+
+#endif // NOTICE_TICKER_H
@@ -0,0 +1,342 @@
+﻿#include "PaintProfiler.h"
+#include <QApplication>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const int kRefreshIntervalMs = 33;   // 叠加层刷新间隔
+const int kFlashDurationMs = 500;    // 重绘区域闪烁时长
+const int kMaxLines = 12;            // 最多显示的控件行数
+const int kMaxFlashes = 64;          // 最多同时保留的闪烁区域
+
+// 一次重绘结束后才会处理的标记事件
+const QEvent::Type kPaintEndEvent = QEvent::Type(QEvent::registerEventType());
+}
+
+PaintProfiler::PaintProfiler(QObject* parent)
+    : QObject(parent),
+    m_enabled(false), m_paintEndPosted(false), m_refreshTimer(nullptr)
+{
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PaintProfiler::refreshOverlays);
+}
+
+PaintProfiler::~PaintProfiler()
+{
+    setEnabled(false);
+    for (Target& target : m_targets) {
+        delete target.overlay;
+    }
+}
+
+void PaintProfiler::attach(QWidget* window)
+{
+    if (!window) {
+        return;
+    }
+
+    Target target;
+    target.window = window;
+    m_targets.push_back(target);
+
+    if (m_enabled) {
+        Target& added = m_targets.back();
+        added.overlay = new ProfilerOverlay(window);
+        added.overlay->followTarget();
+    }
+}
+
+void PaintProfiler::toggle()
+{
+    setEnabled(!m_enabled);
+}
+
+void PaintProfiler::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+
+    if (enabled) {
+        for (Target& target : m_targets) {
+            target.widgets.clear();
+            target.layoutRequests = 0;
+            if (!target.overlay && target.window) {
+                target.overlay = new ProfilerOverlay(target.window);
+            }
+            if (target.overlay) {
+                target.overlay->followTarget();
+            }
+        }
+        m_windowTimer.start();
+        qApp->installEventFilter(this);
+        m_refreshTimer->start();
+        qDebug() << "绘制分析叠加层已开启";
+    }
+    else {
+        qApp->removeEventFilter(this);
+        m_paintWidget = nullptr;
+        m_paintTimer.invalidate();
+        m_paintEndPosted = false; // 尚未处理的标记事件到达时只会提前结束一次计时
+        m_refreshTimer->stop();
+        for (Target& target : m_targets) {
+            if (target.overlay) {
+                target.overlay->hide();
+            }
+        }
+        qDebug() << "绘制分析叠加层已关闭";
+    }
+}
+
+PaintProfiler::Target* PaintProfiler::targetFor(QWidget* widget)
+{
+    QWidget* window = widget->window();
+    for (Target& target : m_targets) {
+        if (target.window == window) {
+            return &target;
+        }
+    }
+    return nullptr;
+}
+
+// 结束上一个绘制的计时并计入统计
+void PaintProfiler::finishPaint()
+{
+    if (!m_paintTimer.isValid()) {
+        return;
+    }
+    const qint64 elapsedNs = m_paintTimer.nsecsElapsed();
+    m_paintTimer.invalidate();
+
+    QWidget* widget = m_paintWidget;
+    m_paintWidget = nullptr;
+    if (!widget) {
+        return; // 绘制期间控件已被删除
+    }
+    Target* target = targetFor(widget);
+    if (!target) {
+        return;
+    }
+
+    auto it = target->widgets.find(widget);
+    if (it == target->widgets.end()) {
+        it = target->widgets.insert(widget, WidgetStats());
+        connect(widget, &QObject::destroyed, this, &PaintProfiler::forgetWidget, Qt::UniqueConnection);
+    }
+    WidgetStats& stats = it.value();
+    if (stats.name.isEmpty()) {
+        stats.name = widget->objectName().isEmpty()
+            ? QString::fromLatin1(widget->metaObject()->className())
+            : QString("%1#%2").arg(widget->metaObject()->className(), widget->objectName());
+    }
+    stats.paints++;
+    stats.paintNs += elapsedNs;
+    stats.maxPaintNs = std::max(stats.maxPaintNs, elapsedNs);
+}
+
+bool PaintProfiler::eventFilter(QObject* watched, QEvent* event)
+{
+    // 绘制事件不由这里分发（否则会跳过控件自己的事件过滤器，如 QScrollArea 视口的绘制转发），
+    // 而是把一次重绘中依次送达的绘制事件首尾相接：任何下一个事件到达时上一个绘制结束。
+    // 父控件的耗时因此不含子控件，最后一个绘制由重绘结束后才处理的标记事件结束
+    finishPaint();
+
+    const QEvent::Type type = event->type();
+    if (watched == this && type == kPaintEndEvent) {
+        m_paintEndPosted = false;
+        return true;
+    }
+    if (type != QEvent::Paint && type != QEvent::LayoutRequest) {
+        return QObject::eventFilter(watched, event);
+    }
+    if (!watched->isWidgetType()) {
+        return QObject::eventFilter(watched, event);
+    }
+
+    QWidget* widget = static_cast<QWidget*>(watched);
+    Target* target = targetFor(widget);
+    if (!target) {
+        return QObject::eventFilter(watched, event);
+    }
+
+    if (type == QEvent::LayoutRequest) {
+        target->layoutRequests++;
+        return QObject::eventFilter(watched, event);
+    }
+
+    if (target->overlay && target->window) {
+        const QRegion region = static_cast<QPaintEvent*>(event)->region();
+        const QPoint offset = widget->mapTo(target->window, QPoint(0, 0));
+        target->overlay->flash(region.translated(offset));
+    }
+
+    if (!m_paintEndPosted) {
+        m_paintEndPosted = true;
+        QCoreApplication::postEvent(this, new QEvent(kPaintEndEvent));
+    }
+    m_paintWidget = widget;
+    m_paintTimer.start();
+    return QObject::eventFilter(watched, event);
+}
+
+void PaintProfiler::forgetWidget(QObject* object)
+{
+    // 析构中的对象不能再转换成 QWidget，按地址比较
+    for (Target& target : m_targets) {
+        for (auto it = target.widgets.begin(); it != target.widgets.end();) {
+            if (static_cast<QObject*>(it.key()) == object) {
+                it = target.widgets.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
+
+void PaintProfiler::refreshOverlays()
+{
+    if (m_windowTimer.elapsed() >= 1000) {
+        rollStatistics();
+    }
+
+    for (Target& target : m_targets) {
+        if (!target.overlay) {
+            continue;
+        }
+        target.overlay->followTarget();
+        if (target.overlay->isVisible() && target.overlay->hasFlashes()) {
+            target.overlay->update();
+        }
+    }
+}
+
+void PaintProfiler::rollStatistics()
+{
+    const double seconds = m_windowTimer.restart() / 1000.0;
+
+    for (Target& target : m_targets) {
+        if (!target.overlay || !target.window) {
+            continue;
+        }
+
+        std::vector<ProfilerOverlay::Line> lines;
+        int totalPaints = 0;
+        qint64 totalNs = 0;
+        for (auto it = target.widgets.constBegin(); it != target.widgets.constEnd(); ++it) {
+            const WidgetStats& stats = it.value();
+            if (stats.paints == 0) {
+                continue;
+            }
+            totalPaints += stats.paints;
+            totalNs += stats.paintNs;
+            lines.push_back({ stats.name, stats.paints / seconds,
+                stats.paintNs / 1e6 / stats.paints, stats.maxPaintNs / 1e6 });
+        }
+
+        std::sort(lines.begin(), lines.end(), [](const ProfilerOverlay::Line& a, const ProfilerOverlay::Line& b) {
+            return a.avgMs * a.paintsPerSecond > b.avgMs * b.paintsPerSecond;
+        });
+        if (lines.size() > size_t(kMaxLines)) {
+            lines.resize(kMaxLines);
+        }
+
+        const QString summary = QString("%1  重绘 %2/s  绘制 %3ms/s  布局失效 %4/s")
+            .arg(QString::fromLatin1(target.window->metaObject()->className()))
+            .arg(totalPaints / seconds, 0, 'f', 1)
+            .arg(totalNs / 1e6 / seconds, 0, 'f', 2)
+            .arg(target.layoutRequests / seconds, 0, 'f', 1);
+        target.overlay->setSummary(summary, lines);
+
+        target.widgets.clear();
+        target.layoutRequests = 0;
+    }
+}
+
+ProfilerOverlay::ProfilerOverlay(QWidget* target)
+    : QWidget(nullptr), m_target(target)
+{
+    setWindowFlags(Qt::FramelessWindowHint | Qt::Tool | Qt::WindowStaysOnTopHint | Qt::WindowTransparentForInput);
+    setAttribute(Qt::WA_TranslucentBackground);
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+void ProfilerOverlay::setSummary(const QString& summary, const std::vector<Line>& lines)
+{
+    m_summary = summary;
+    m_lines = lines;
+    update();
+}
+
+void ProfilerOverlay::flash(const QRegion& region)
+{
+    if (m_flashes.size() >= size_t(kMaxFlashes)) {
+        m_flashes.erase(m_flashes.begin());
+    }
+    Flash entry;
+    entry.region = region;
+    entry.age.start();
+    m_flashes.push_back(entry);
+}
+
+void ProfilerOverlay::followTarget()
+{
+    // 跟随目标窗口的位置和可见性
+    if (!m_target || !m_target->isVisible()) {
+        if (isVisible()) {
+            hide();
+        }
+        return;
+    }
+
+    if (geometry() != m_target->geometry()) {
+        setGeometry(m_target->geometry());
+    }
+    if (!isVisible()) {
+        show();
+    }
+}
+
+void ProfilerOverlay::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+
+    // 重绘区域：红色半透明，逐渐淡出
+    m_flashes.erase(std::remove_if(m_flashes.begin(), m_flashes.end(), [](const Flash& flash) {
+        return flash.age.elapsed() > kFlashDurationMs;
+    }), m_flashes.end());
+    for (const Flash& flash : m_flashes) {
+        const int alpha = int(120 * (1.0 - double(flash.age.elapsed()) / kFlashDurationMs));
+        for (const QRect& rect : flash.region) {
+            painter.fillRect(rect, QColor(255, 0, 0, alpha));
+            painter.setPen(QColor(255, 0, 0, qMin(255, alpha * 2)));
+            painter.drawRect(rect.adjusted(0, 0, -1, -1));
+        }
+    }
+
+    // 统计信息
+    QFont font = painter.font();
+    font.setPixelSize(12);
+    painter.setFont(font);
+    const int lineHeight = painter.fontMetrics().height();
+    const QRect panel(4, 4, qMin(width() - 8, 420), lineHeight * int(m_lines.size() + 1) + 8);
+    painter.fillRect(panel, QColor(0, 0, 0, 170));
+    painter.setPen(Qt::white);
+
+    int y = panel.top() + 4 + painter.fontMetrics().ascent();
+    painter.drawText(panel.left() + 6, y, m_summary.isEmpty() ? QString("统计中...") : m_summary);
+    for (const Line& line : m_lines) {
+        y += lineHeight;
+        painter.drawText(panel.left() + 6, y, QString("%1  %2/s  平均 %3ms  最大 %4ms")
+            .arg(line.name)
+            .arg(line.paintsPerSecond, 0, 'f', 1)
+            .arg(line.avgMs, 0, 'f', 2)
+            .arg(line.maxMs, 0, 'f', 2));
+    }
+}
@@ -0,0 +1,111 @@
+﻿#ifndef PAINT_PROFILER_H
+#define PAINT_PROFILER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QHash>
+#include <QPointer>
+#include <QRegion>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <vector>
+
+class ProfilerOverlay;
+
+// 绘制/布局分析器：开启时在被分析的窗口上叠加显示每个控件的绘制耗时、
+// 每秒重绘次数、布局失效次数，并闪烁标出实际重绘的区域。
+// 关闭时不安装任何事件过滤器，对正常运行没有额外开销。
+class PaintProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PaintProfiler(QObject* parent = nullptr);
+    ~PaintProfiler() override;
+
+    // 添加需要分析的顶层窗口
+    void attach(QWidget* window);
+
+    bool isEnabled() const { return m_enabled; }
+
+public slots:
+    void setEnabled(bool enabled);
+    void toggle();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void refreshOverlays();
+    // 控件被删除时丢弃它的统计，避免新控件复用同一地址后继承旧数据
+    void forgetWidget(QObject* object);
+
+private:
+    // 单个控件在当前统计窗口内的数据
+    struct WidgetStats {
+        QString name;
+        int paints = 0;
+        qint64 paintNs = 0;
+        qint64 maxPaintNs = 0;
+    };
+
+    // 单个顶层窗口的数据
+    struct Target {
+        QPointer<QWidget> window;
+        ProfilerOverlay* overlay = nullptr;
+        QHash<QWidget*, WidgetStats> widgets; // 控件删除时由 forgetWidget 移除
+        int layoutRequests = 0;
+    };
+
+    Target* targetFor(QWidget* widget);
+    void finishPaint();
+    void rollStatistics();
+
+    std::vector<Target> m_targets;
+    bool m_enabled;
+    // 正在计时的绘制：绘制事件照常由 Qt 分发，计到下一个事件到达过滤器为止
+    QPointer<QWidget> m_paintWidget;
+    QElapsedTimer m_paintTimer;
+    bool m_paintEndPosted; // 已投递标记事件，保证一次重绘的最后一个绘制也能结束计时
+    QTimer* m_refreshTimer;
+    QElapsedTimer m_windowTimer; // 统计窗口计时（每秒滚动一次）
+};
+
+// 叠加层：独立的透明置顶窗口，不接收输入，重绘时不会引起下层窗口重绘
+class ProfilerOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilerOverlay(QWidget* target);
+
+    struct Line {
+        QString name;
+        double paintsPerSecond;
+        double avgMs;
+        double maxMs;
+    };
+
+    void setSummary(const QString& summary, const std::vector<Line>& lines);
+    void flash(const QRegion& region);
+    void followTarget();
+
+    // 是否还有未消失的闪烁区域
+    bool hasFlashes() const { return !m_flashes.empty(); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Flash {
+        QRegion region;
+        QElapsedTimer age;
+    };
+
+    QPointer<QWidget> m_target;
+    QString m_summary;
+    std::vector<Line> m_lines;
+    std::vector<Flash> m_flashes;
+};
+
+#endif // PAINT_PROFILER_H
@@ -0,0 +1,154 @@
+﻿#include "PanelScheduler.h"
+#include "InfoPanel.h"
+#include "ClockSource.h"
+#include "DiagnosticsLog.h"
+#include "EventLoopMonitor.h"
+#include <QEvent>
+#include <QDebug>
+
+namespace {
+// 同一面板超出预算的日志最短间隔
+const qint64 kReportIntervalMs = 60000;
+}
+
+PanelScheduler::PanelScheduler(QObject* parent)
+    : QObject(parent),
+    m_timer(nullptr), m_overrunCount(0)
+{
+    m_clock.start();
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::CoarseTimer); // 允许系统合并唤醒
+    connect(m_timer, &QTimer::timeout, this, &PanelScheduler::tick);
+
+    connect(ClockSource::instance(), &ClockSource::timeJumped, this, &PanelScheduler::refreshAll, Qt::QueuedConnection);
+}
+
+void PanelScheduler::addPanel(InfoPanel* panel)
+{
+    Entry entry;
+    entry.panel = panel;
+    m_entries.push_back(entry);
+
+    panel->installEventFilter(this);
+    connect(panel, &InfoPanel::painted, this, [this, panel](double ms) {
+        if (Entry* entry = entryFor(panel)) {
+            checkBudget(*entry, "绘制", ms);
+        }
+    });
+    connect(panel, &QObject::destroyed, this, [this, panel]() {
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->panel == panel) {
+                m_entries.erase(it);
+                break;
+            }
+        }
+    });
+
+    panel->setVisible(panel->isConfigured());
+    scheduleNext();
+}
+
+void PanelScheduler::reloadPanels()
+{
+    for (Entry& entry : m_entries) {
+        entry.panel->applyFontSize();
+        entry.panel->setVisible(entry.panel->isConfigured());
+    }
+    refreshAll();
+}
+
+void PanelScheduler::refreshAll()
+{
+    for (Entry& entry : m_entries) {
+        entry.nextDueMs = 0;
+    }
+    tick();
+}
+
+PanelScheduler::Entry* PanelScheduler::entryFor(QObject* panel)
+{
+    for (Entry& entry : m_entries) {
+        if (entry.panel == panel) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool PanelScheduler::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Show) {
+        // 重新显示时内容可能已经过期，排队立即刷新
+        if (Entry* entry = entryFor(watched)) {
+            entry->nextDueMs = 0;
+            m_timer->start(0);
+        }
+    }
+    else if (event->type() == QEvent::Hide) {
+        scheduleNext();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void PanelScheduler::tick()
+{
+    EventLoopMonitor::ActivityScope activity("PanelScheduler::tick");
+    const qint64 nowMs = m_clock.elapsed();
+    for (Entry& entry : m_entries) {
+        if (entry.panel->isVisible() && entry.nextDueMs <= nowMs) {
+            refreshEntry(entry, nowMs);
+        }
+    }
+    scheduleNext();
+}
+
+void PanelScheduler::refreshEntry(Entry& entry, qint64 nowMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    entry.panel->refresh(ClockSource::instance()->now());
+    const double refreshMs = timer.nsecsElapsed() / 1000000.0;
+    entry.nextDueMs = nowMs + qMax(1, entry.panel->updateIntervalMs());
+
+    checkBudget(entry, "刷新", refreshMs);
+}
+
+void PanelScheduler::checkBudget(Entry& entry, const QString& phase, double ms)
+{
+    const double budget = entry.panel->budgetMs();
+    if (ms <= budget) {
+        return;
+    }
+
+    m_overrunCount++;
+    const qint64 nowMs = m_clock.elapsed();
+    if (entry.lastReportMs >= 0 && nowMs - entry.lastReportMs < kReportIntervalMs) {
+        return;
+    }
+    entry.lastReportMs = nowMs;
+
+    const QString message = QString("面板 %1 %2 耗时 %3ms，超出预算 %4ms")
+        .arg(entry.panel->panelName(), phase)
+        .arg(ms, 0, 'f', 2).arg(budget, 0, 'f', 2);
+    qWarning().noquote() << message;
+    DiagnosticsLog::instance().write("panel", message);
+}
+
+void PanelScheduler::scheduleNext()
+{
+    // 只看可见面板，全部不可见时停止定时器，空闲时不唤醒
+    qint64 nextDueMs = -1;
+    for (const Entry& entry : m_entries) {
+        if (entry.panel->isVisible() && (nextDueMs < 0 || entry.nextDueMs < nextDueMs)) {
+            nextDueMs = entry.nextDueMs;
+        }
+    }
+
+    if (nextDueMs < 0) {
+        m_timer->stop();
+        return;
+    }
+    m_timer->start(int(qMax<qint64>(0, nextDueMs - m_clock.elapsed())));
+}
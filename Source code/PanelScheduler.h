@@ -0,0 +1,57 @@
+﻿#ifndef PANEL_SCHEDULER_H
+#define PANEL_SCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <vector>
+
+class InfoPanel;
+
+// 信息面板调度器：所有面板共用一个单次定时器，每次只唤醒到最近一个到期的面板。
+// 不可见的面板（包括所在窗口隐藏时）不刷新也不参与计时，全部不可见时定时器停止；
+// 面板重新显示时立即刷新一次。刷新或绘制超出面板预算时写入诊断日志。
+class PanelScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PanelScheduler(QObject* parent = nullptr);
+
+    void addPanel(InfoPanel* panel);
+
+    // 设置变化后按配置显示/隐藏面板并立即刷新
+    void reloadPanels();
+
+    // 超出预算的累计次数
+    int overrunCount() const { return m_overrunCount; }
+
+public slots:
+    // 所有可见面板立即刷新（时间跳变、课表修改等）
+    void refreshAll();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void tick();
+
+private:
+    struct Entry {
+        InfoPanel* panel = nullptr;
+        qint64 nextDueMs = 0;
+        qint64 lastReportMs = -1;
+    };
+
+    Entry* entryFor(QObject* panel);
+    void refreshEntry(Entry& entry, qint64 nowMs);
+    void checkBudget(Entry& entry, const QString& phase, double ms);
+    void scheduleNext();
+
+    std::vector<Entry> m_entries;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;   // 调度使用单调时间，不受系统时间调整影响
+    int m_overrunCount;
+};
+
+#endif // PANEL_SCHEDULER_H
@@ -0,0 +1,261 @@
+﻿#include "ScheduleEditorDialog.h"
+#include "SettingsModel.h"
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QDebug>
+
+ScheduleEditorDialog::ScheduleEditorDialog(SettingsModel* model, QWidget* parent)
+    : QDialog(parent),
+    m_model(model),
+    m_errorLabel(nullptr), m_dayCombo(nullptr), m_courseList(nullptr),
+    m_fontSizeSpin(nullptr), m_transparencySpin(nullptr), m_rangeTable(nullptr),
+    m_updating(false)
+{
+    setWindowTitle("编辑课程表");
+    // 课程表窗口位于底层，编辑器需要保持在最上面
+    setWindowFlags(windowFlags() | Qt::WindowStaysOnTopHint);
+    resize(420, 640);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    // 加载或校验错误
+    m_errorLabel = new QLabel(this);
+    m_errorLabel->setWordWrap(true);
+    m_errorLabel->setStyleSheet("color: #c00000;");
+    m_errorLabel->hide();
+    layout->addWidget(m_errorLabel);
+
+    // 课程
+    QGroupBox* courseGroup = new QGroupBox("课程", this);
+    QVBoxLayout* courseLayout = new QVBoxLayout(courseGroup);
+
+    m_dayCombo = new QComboBox(courseGroup);
+    m_dayCombo->addItems({ "星期一", "星期二", "星期三", "星期四", "星期五", "星期六", "星期日" });
+    courseLayout->addWidget(m_dayCombo);
+
+    m_courseList = new QListWidget(courseGroup);
+    courseLayout->addWidget(m_courseList, 1);
+
+    QHBoxLayout* courseButtons = new QHBoxLayout();
+    QPushButton* addCourseBtn = new QPushButton("添加", courseGroup);
+    QPushButton* removeCourseBtn = new QPushButton("删除", courseGroup);
+    courseButtons->addStretch();
+    courseButtons->addWidget(addCourseBtn);
+    courseButtons->addWidget(removeCourseBtn);
+    courseLayout->addLayout(courseButtons);
+
+    layout->addWidget(courseGroup, 1);
+
+    // 显示
+    QGroupBox* displayGroup = new QGroupBox("显示", this);
+    QFormLayout* displayLayout = new QFormLayout(displayGroup);
+
+    m_fontSizeSpin = new QSpinBox(displayGroup);
+    m_fontSizeSpin->setRange(8, 120);
+    m_fontSizeSpin->setSuffix(" px");
+    displayLayout->addRow("课程字体大小", m_fontSizeSpin);
+
+    m_transparencySpin = new QDoubleSpinBox(displayGroup);
+    m_transparencySpin->setRange(0.1, 1.0);
+    m_transparencySpin->setSingleStep(0.05);
+    m_transparencySpin->setDecimals(2);
+    displayLayout->addRow("透明度", m_transparencySpin);
+
+    layout->addWidget(displayGroup);
+
+    // 置顶时间段
+    QGroupBox* rangeGroup = new QGroupBox("置顶时间段 (HH:mm)", this);
+    QVBoxLayout* rangeLayout = new QVBoxLayout(rangeGroup);
+
+    m_rangeTable = new QTableWidget(0, 2, rangeGroup);
+    m_rangeTable->setHorizontalHeaderLabels({ "开始", "结束" });
+    m_rangeTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_rangeTable->verticalHeader()->hide();
+    rangeLayout->addWidget(m_rangeTable);
+
+    QHBoxLayout* rangeButtons = new QHBoxLayout();
+    QPushButton* addRangeBtn = new QPushButton("添加", rangeGroup);
+    QPushButton* removeRangeBtn = new QPushButton("删除", rangeGroup);
+    rangeButtons->addStretch();
+    rangeButtons->addWidget(addRangeBtn);
+    rangeButtons->addWidget(removeRangeBtn);
+    rangeLayout->addLayout(rangeButtons);
+
+    layout->addWidget(rangeGroup);
+
+    QPushButton* closeBtn = new QPushButton("关闭", this);
+    QHBoxLayout* bottomLayout = new QHBoxLayout();
+    bottomLayout->addStretch();
+    bottomLayout->addWidget(closeBtn);
+    layout->addLayout(bottomLayout);
+
+    connect(m_dayCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &ScheduleEditorDialog::reloadCourses);
+    connect(m_courseList, &QListWidget::itemChanged, this, &ScheduleEditorDialog::onCourseEdited);
+    connect(addCourseBtn, &QPushButton::clicked, this, &ScheduleEditorDialog::addCourse);
+    connect(removeCourseBtn, &QPushButton::clicked, this, &ScheduleEditorDialog::removeCourse);
+    connect(m_fontSizeSpin, qOverload<int>(&QSpinBox::valueChanged), this, [this](int size) {
+        if (!m_updating) {
+            m_model->setCourseFontSize(size);
+        }
+    });
+    connect(m_transparencySpin, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this](double transparency) {
+        if (!m_updating) {
+            m_model->setTransparency(transparency);
+        }
+    });
+    connect(m_rangeTable, &QTableWidget::itemChanged, this, &ScheduleEditorDialog::commitTimeRanges);
+    connect(addRangeBtn, &QPushButton::clicked, this, &ScheduleEditorDialog::addTimeRange);
+    connect(removeRangeBtn, &QPushButton::clicked, this, &ScheduleEditorDialog::removeTimeRange);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+
+    // 设置文件被重新加载或课程行数变化时刷新
+    connect(m_model, &SettingsModel::settingsReloaded, this, &ScheduleEditorDialog::reloadAll);
+    connect(m_model, &SettingsModel::dayChanged, this, [this](int day) {
+        if (day == selectedDay()) {
+            reloadCourses();
+        }
+    });
+
+    reloadAll();
+}
+
+void ScheduleEditorDialog::done(int result)
+{
+    // 关闭时立即写回尚未保存的修改
+    m_model->flush();
+    QDialog::done(result);
+}
+
+void ScheduleEditorDialog::showError(const QString& message)
+{
+    m_errorLabel->setText(message);
+    m_errorLabel->setVisible(!message.isEmpty());
+}
+
+void ScheduleEditorDialog::reloadAll()
+{
+    const ScheduleSettings& settings = m_model->settings();
+    showError(m_model->lastError());
+
+    m_updating = true;
+    m_fontSizeSpin->setValue(settings.courseFontSize);
+    m_transparencySpin->setValue(settings.transparency);
+
+    m_rangeTable->setRowCount(0);
+    for (const TimeRange& range : settings.topmostTimeRanges) {
+        int row = m_rangeTable->rowCount();
+        m_rangeTable->insertRow(row);
+        m_rangeTable->setItem(row, 0, new QTableWidgetItem(range.start));
+        m_rangeTable->setItem(row, 1, new QTableWidgetItem(range.end));
+    }
+    m_updating = false;
+
+    reloadCourses();
+}
+
+void ScheduleEditorDialog::reloadCourses()
+{
+    m_updating = true;
+    const int currentRow = m_courseList->currentRow();
+    m_courseList->clear();
+    for (const QString& course : m_model->settings().schedules.day(selectedDay())) {
+        QListWidgetItem* item = new QListWidgetItem(course, m_courseList);
+        item->setFlags(item->flags() | Qt::ItemIsEditable);
+    }
+    m_courseList->setCurrentRow(qMin(currentRow, m_courseList->count() - 1));
+    m_updating = false;
+}
+
+void ScheduleEditorDialog::onCourseEdited(QListWidgetItem* item)
+{
+    if (m_updating) {
+        return;
+    }
+    m_model->setCourse(selectedDay(), m_courseList->row(item), item->text().trimmed());
+}
+
+void ScheduleEditorDialog::addCourse()
+{
+    // 插入到选中行之后，编辑新行
+    int row = m_courseList->currentRow() + 1;
+    if (row <= 0) {
+        row = m_courseList->count();
+    }
+    m_model->insertCourse(selectedDay(), row, "新课程");
+    m_courseList->setCurrentRow(row);
+    if (QListWidgetItem* item = m_courseList->item(row)) {
+        m_courseList->editItem(item);
+    }
+}
+
+void ScheduleEditorDialog::removeCourse()
+{
+    int row = m_courseList->currentRow();
+    if (row >= 0) {
+        m_model->removeCourse(selectedDay(), row);
+    }
+}
+
+void ScheduleEditorDialog::addTimeRange()
+{
+    m_updating = true;
+    int row = m_rangeTable->rowCount();
+    m_rangeTable->insertRow(row);
+    m_rangeTable->setItem(row, 0, new QTableWidgetItem("08:00"));
+    m_rangeTable->setItem(row, 1, new QTableWidgetItem("12:00"));
+    m_updating = false;
+    commitTimeRanges();
+}
+
+void ScheduleEditorDialog::removeTimeRange()
+{
+    int row = m_rangeTable->currentRow();
+    if (row >= 0) {
+        m_rangeTable->removeRow(row);
+        commitTimeRanges();
+    }
+}
+
+void ScheduleEditorDialog::commitTimeRanges()
+{
+    if (m_updating) {
+        return;
+    }
+
+    // 逐格校验并标红，全部有效时才提交
+    m_updating = true;
+    std::vector<TimeRange> ranges;
+    bool valid = true;
+    for (int row = 0; row < m_rangeTable->rowCount(); row++) {
+        TimeRange range;
+        for (int column = 0; column < 2; column++) {
+            QTableWidgetItem* item = m_rangeTable->item(row, column);
+            const QString text = item ? item->text().trimmed() : QString();
+            const bool ok = SettingsModel::isValidTime(text);
+            if (item) {
+                item->setBackground(ok ? QBrush() : QBrush(QColor(255, 200, 200)));
+            }
+            valid = valid && ok;
+            (column == 0 ? range.start : range.end) = text;
+        }
+        ranges.push_back(range);
+    }
+    m_updating = false;
+
+    if (!valid) {
+        showError("置顶时间段格式应为 HH:mm（如 07:30），修正前不会保存");
+        return;
+    }
+
+    QString error;
+    if (m_model->setTopmostTimeRanges(ranges, &error)) {
+        showError(QString());
+    }
+    else {
+        showError(error);
+    }
+}
@@ -0,0 +1,50 @@
+﻿#ifndef SCHEDULE_EDITOR_DIALOG_H
+#define SCHEDULE_EDITOR_DIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+
+class SettingsModel;
+
+// 课表编辑器：直接修改共享的设置模型，每次修改立即反映到显示窗口，
+// 写回文件由模型延迟合并，关闭编辑器时立即写回
+class ScheduleEditorDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ScheduleEditorDialog(SettingsModel* model, QWidget* parent = nullptr);
+
+    void done(int result) override;
+
+private slots:
+    void reloadAll();
+    void reloadCourses();
+    void onCourseEdited(QListWidgetItem* item);
+    void addCourse();
+    void removeCourse();
+    void addTimeRange();
+    void removeTimeRange();
+    void commitTimeRanges();
+
+private:
+    int selectedDay() const { return m_dayCombo->currentIndex(); }
+    void showError(const QString& message);
+
+    SettingsModel* m_model;
+
+    QLabel* m_errorLabel;
+    QComboBox* m_dayCombo;
+    QListWidget* m_courseList;
+    QSpinBox* m_fontSizeSpin;
+    QDoubleSpinBox* m_transparencySpin;
+    QTableWidget* m_rangeTable;
+    bool m_updating; // 填充控件时不回写模型
+};
+
+#endif // SCHEDULE_EDITOR_DIALOG_H
@@ -0,0 +1,242 @@
+﻿#include "ScheduleStore.h"
+#include <QJsonArray>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+
+const QStringList& ScheduleStore::weekdayNames()
+{
+    static const QStringList names = { "Monday", "Tuesday", "Wednesday", "Thursday",
+                                       "Friday", "Saturday", "Sunday" };
+    return names;
+}
+
+int ScheduleStore::weekdayIndex(const QString& name)
+{
+    return weekdayNames().indexOf(name);
+}
+
+ScheduleStore::ScheduleStore()
+{
+    m_dayTemplate.fill(-1);
+}
+
+bool ScheduleStore::hasDay(int day) const
+{
+    return day >= 0 && day < kDayCount && m_dayTemplate[day] >= 0;
+}
+
+const QStringList& ScheduleStore::day(int day) const
+{
+    static const QStringList empty;
+    if (!hasDay(day)) {
+        return empty;
+    }
+    return m_templates[m_dayTemplate[day]].courses;
+}
+
+void ScheduleStore::setDay(int day, const QStringList& courses)
+{
+    if (day < 0 || day >= kDayCount) {
+        return;
+    }
+    m_dayTemplate[day] = findOrAddTemplate(courses, QString());
+    removeUnusedTemplates();
+}
+
+bool ScheduleStore::hasTemplate(const QString& name) const
+{
+    return !name.isEmpty() && std::any_of(m_templates.begin(), m_templates.end(),
+        [&name](const Template& t) { return t.name == name; });
+}
+
+const QStringList& ScheduleStore::templateCourses(const QString& name) const
+{
+    static const QStringList empty;
+    for (const Template& t : m_templates) {
+        if (!name.isEmpty() && t.name == name) {
+            return t.courses;
+        }
+    }
+    return empty;
+}
+
+void ScheduleStore::clear()
+{
+    m_templates.clear();
+    m_dayTemplate.fill(-1);
+    m_pool.clear();
+}
+
+QString ScheduleStore::intern(const QString& text)
+{
+    auto it = m_pool.constFind(text);
+    if (it != m_pool.constEnd()) {
+        return *it; // 共享已有字符串的数据
+    }
+    m_pool.insert(text);
+    return text;
+}
+
+QStringList ScheduleStore::internAll(const QStringList& courses)
+{
+    QStringList result;
+    result.reserve(courses.size());
+    for (const QString& course : courses) {
+        result.append(intern(course));
+    }
+    return result;
+}
+
+int ScheduleStore::findOrAddTemplate(const QStringList& courses, const QString& name)
+{
+    // 有名称的模板按名称匹配，内容相同的不同名称各自保留
+    if (!name.isEmpty()) {
+        for (size_t i = 0; i < m_templates.size(); i++) {
+            if (m_templates[i].name == name) {
+                return int(i);
+            }
+        }
+    }
+
+    const QStringList* sharedCourses = nullptr;
+    for (size_t i = 0; i < m_templates.size(); i++) {
+        if (m_templates[i].courses != courses) {
+            continue;
+        }
+        if (name.isEmpty()) {
+            return int(i);
+        }
+        if (m_templates[i].name.isEmpty()) {
+            m_templates[i].name = name;
+            return int(i);
+        }
+        sharedCourses = &m_templates[i].courses;
+    }
+
+    // 内容与已有模板相同时共享同一份课程列表数据
+    m_templates.push_back({ name, sharedCourses ? *sharedCourses : internAll(courses) });
+    return int(m_templates.size() - 1);
+}
+
+void ScheduleStore::removeUnusedTemplates()
+{
+    // 有名称的模板来自配置文件，即使当前没有星期引用也保留
+    std::vector<bool> keep(m_templates.size(), false);
+    for (size_t i = 0; i < m_templates.size(); i++) {
+        keep[i] = !m_templates[i].name.isEmpty();
+    }
+    for (int index : m_dayTemplate) {
+        if (index >= 0) {
+            keep[index] = true;
+        }
+    }
+
+    std::vector<int> remap(m_templates.size(), -1);
+    std::vector<Template> kept;
+    for (size_t i = 0; i < m_templates.size(); i++) {
+        if (keep[i]) {
+            remap[i] = int(kept.size());
+            kept.push_back(m_templates[i]);
+        }
+    }
+    for (int& index : m_dayTemplate) {
+        if (index >= 0) {
+            index = remap[index];
+        }
+    }
+    m_templates.swap(kept);
+}
+
+void ScheduleStore::loadJson(const QJsonObject& schedules, const QJsonObject& templates)
+{
+    clear();
+
+    auto readCourses = [](const QJsonArray& array) {
+        QStringList courses;
+        courses.reserve(array.size());
+        for (const QJsonValue& course : array) {
+            courses.append(course.toString());
+        }
+        return courses;
+    };
+
+    // 每个模板只解析一次
+    QHash<QString, int> templateIndex;
+    for (auto it = templates.constBegin(); it != templates.constEnd(); ++it) {
+        templateIndex.insert(it.key(), findOrAddTemplate(readCourses(it.value().toArray()), it.key()));
+    }
+
+    for (int day = 0; day < kDayCount; day++) {
+        const QJsonValue value = schedules.value(weekdayNames()[day]);
+        if (value.isString()) {
+            auto it = templateIndex.constFind(value.toString());
+            if (it == templateIndex.constEnd()) {
+                qDebug() << weekdayNames()[day] << "引用了不存在的课表模板:" << value.toString();
+                continue;
+            }
+            m_dayTemplate[day] = it.value();
+        }
+        else if (value.isArray()) {
+            m_dayTemplate[day] = findOrAddTemplate(readCourses(value.toArray()), QString());
+        }
+    }
+
+    removeUnusedTemplates();
+}
+
+void ScheduleStore::saveJson(QJsonObject& schedules, QJsonObject& templates) const
+{
+    std::vector<int> useCount(m_templates.size(), 0);
+    for (int index : m_dayTemplate) {
+        if (index >= 0) {
+            useCount[index]++;
+        }
+    }
+
+    // 被多天共享或有名称的模板写入 templates；
+    // 配置文件中的模板名保持不变，未命名的共享模板自动命名
+    QSet<QString> usedNames;
+    for (const Template& t : m_templates) {
+        if (!t.name.isEmpty()) {
+            usedNames.insert(t.name);
+        }
+    }
+
+    QStringList names;
+    for (size_t i = 0; i < m_templates.size(); i++) {
+        QString name = m_templates[i].name;
+        if (name.isEmpty() && useCount[i] > 1) {
+            name = QString("default");
+            for (int n = 1; usedNames.contains(name); n++) {
+                name = QString("template%1").arg(n);
+            }
+            usedNames.insert(name);
+        }
+        if (!name.isEmpty()) {
+            QJsonArray courses;
+            for (const QString& course : m_templates[i].courses) {
+                courses.append(course);
+            }
+            templates[name] = courses;
+        }
+        names.append(name);
+    }
+
+    for (int day = 0; day < kDayCount; day++) {
+        const int index = m_dayTemplate[day];
+        if (index < 0) {
+            continue;
+        }
+        if (!names[index].isEmpty()) {
+            schedules[weekdayNames()[day]] = names[index];
+        }
+        else {
+            QJsonArray courses;
+            for (const QString& course : m_templates[index].courses) {
+                courses.append(course);
+            }
+            schedules[weekdayNames()[day]] = courses;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+﻿#ifndef SCHEDULE_STORE_H
+#define SCHEDULE_STORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QJsonObject>
+#include <array>
+#include <vector>
+
+// 课程表存储：按星期下标（0 = 周一）直接索引。
+// 内容相同的星期共享同一个课表模板，课程名称字符串经过驻留，
+// 在 JSON 中可以通过 schedule_templates 引用共享模板，只解析和保存一次。
+class ScheduleStore
+{
+public:
+    static constexpr int kDayCount = 7;
+
+    // JSON 中使用的英文星期名（Monday ... Sunday）
+    static const QStringList& weekdayNames();
+    // 英文星期名转下标，无法识别时返回 -1
+    static int weekdayIndex(const QString& name);
+
+    ScheduleStore();
+
+    bool hasDay(int day) const;
+    // 该星期的课程列表，没有时返回空列表
+    const QStringList& day(int day) const;
+    void setDay(int day, const QStringList& courses);
+    void clear();
+
+    // 当前不同课表模板的数量
+    int templateCount() const { return int(m_templates.size()); }
+    // 按名称查找课表模板，没有时返回 false
+    bool hasTemplate(const QString& name) const;
+    const QStringList& templateCourses(const QString& name) const;
+
+    // 从 "schedules" 和 "schedule_templates" 读取；
+    // schedules 中每一天可以是课程数组，也可以是模板名
+    void loadJson(const QJsonObject& schedules, const QJsonObject& templates);
+    // 被多天共享或有名称的模板写入 templates，其余直接内联
+    void saveJson(QJsonObject& schedules, QJsonObject& templates) const;
+
+private:
+    struct Template {
+        QString name;
+        QStringList courses;
+    };
+
+    QString intern(const QString& text);
+    QStringList internAll(const QStringList& courses);
+    int findOrAddTemplate(const QStringList& courses, const QString& name);
+    void removeUnusedTemplates();
+
+    std::vector<Template> m_templates;
+    std::array<int, kDayCount> m_dayTemplate; // 模板下标，-1 表示没有课表
+    QSet<QString> m_pool;                     // 驻留的课程名称
+};
+
+#endif // SCHEDULE_STORE_H
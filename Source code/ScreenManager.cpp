@@ -0,0 +1,118 @@
+﻿#include "ScreenManager.h"
+#include "SettingsModel.h"
+#include <QGuiApplication>
+#include <QDebug>
+
+ScreenManager::ScreenManager(SettingsModel* model, const AppOptions& options, QObject* parent)
+    : QObject(parent),
+    m_model(model),
+    m_options(options),
+    m_primary(nullptr),
+    m_primaryScreen(nullptr)
+{
+}
+
+ScreenManager::~ScreenManager()
+{
+    qDeleteAll(m_mirrors);
+    m_mirrors.clear();
+    delete m_primary;
+    m_primary = nullptr;
+
+    // 实例共用模型，由这里统一保存一次
+    m_model->save();
+}
+
+void ScreenManager::start()
+{
+    connect(qApp, &QGuiApplication::screenAdded, this, &ScreenManager::onScreenAdded);
+    connect(qApp, &QGuiApplication::screenRemoved, this, &ScreenManager::onScreenRemoved);
+    connect(qApp, &QGuiApplication::primaryScreenChanged, this, &ScreenManager::syncScreens);
+    connect(m_model, &SettingsModel::settingsReloaded, this, &ScreenManager::syncScreens);
+
+    syncScreens();
+}
+
+QScreen* ScreenManager::scheduleScreen() const
+{
+    const QString name = m_model->settings().scheduleScreen;
+    if (!name.isEmpty()) {
+        for (QScreen* screen : QGuiApplication::screens()) {
+            if (screen->name() == name) {
+                return screen;
+            }
+        }
+        qDebug() << "未找到配置的屏幕" << name << "，使用主屏幕";
+    }
+    return QGuiApplication::primaryScreen();
+}
+
+ClassScheduleApp* ScreenManager::createInstance(QScreen* screen, bool primary)
+{
+    AppOptions options = m_options;
+    if (!primary) {
+        // 镜像不重复设置开机自启，也不重复监控同一个事件循环；
+        // 应用级快捷键只能有一个，否则多个实例同时注册会变成 activatedAmbiguously 而不触发
+        options.autoStart = false;
+        options.monitorEventLoop = false;
+        options.profileOverlay = false;
+        options.profilerShortcut = false;
+    }
+    return new ClassScheduleApp(options, m_model, screen);
+}
+
+void ScreenManager::syncScreens()
+{
+    QScreen* target = scheduleScreen();
+    if (!target) {
+        return;
+    }
+
+    // 主实例：已存在时只移动到目标屏幕
+    if (!m_primary) {
+        // 目标屏幕上原来的镜像由主实例取代
+        delete m_mirrors.take(target);
+        m_primary = createInstance(target, true);
+    }
+    else if (m_primaryScreen != target) {
+        delete m_mirrors.take(target);
+        m_primary->setBoardScreen(target);
+    }
+    m_primaryScreen = target;
+
+    // 镜像：每个其他屏幕一个
+    const bool mirror = m_model->settings().mirrorScreens;
+    for (QScreen* screen : QGuiApplication::screens()) {
+        if (screen == target) {
+            continue;
+        }
+        if (mirror && !m_mirrors.contains(screen)) {
+            m_mirrors.insert(screen, createInstance(screen, false));
+        }
+        else if (!mirror && m_mirrors.contains(screen)) {
+            delete m_mirrors.take(screen);
+        }
+    }
+
+    qDebug() << "课程表屏幕:" << target->name() << "镜像数量:" << m_mirrors.size();
+}
+
+void ScreenManager::onScreenAdded(QScreen* screen)
+{
+    qDebug() << "屏幕接入:" << screen->name() << screen->geometry();
+    syncScreens();
+}
+
+void ScreenManager::onScreenRemoved(QScreen* screen)
+{
+    qDebug() << "屏幕移除:" << screen->name();
+
+    delete m_mirrors.take(screen);
+    if (screen == m_primaryScreen) {
+        // 主实例所在屏幕被拔掉，清空后由 syncScreens 移到新的目标屏幕
+        m_primaryScreen = nullptr;
+    }
+
+    // screenRemoved 发出时该屏幕仍在 screens() 列表中，延后再同步
+    QMetaObject::invokeMethod(this, &ScreenManager::syncScreens, Qt::QueuedConnection);
+}
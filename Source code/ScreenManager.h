@@ -0,0 +1,41 @@
+﻿#ifndef SCREEN_MANAGER_H
+#define SCREEN_MANAGER_H
+
+#include <QObject>
+#include <QScreen>
+#include <QHash>
+#include "ClassScheduleApp.h"
+
+class SettingsModel;
+
+// 多屏幕管理：在配置的屏幕（默认主屏幕）上显示课程表，
+// 开启 mirror_screens 时在其他屏幕上各显示一个镜像。所有实例共用同一个设置模型，
+// 屏幕插拔或主屏幕变化时只新建/销毁对应实例，其余实例只按所在屏幕重新布局。
+class ScreenManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    ScreenManager(SettingsModel* model, const AppOptions& options, QObject* parent = nullptr);
+    ~ScreenManager();
+
+    // 按当前屏幕创建窗口
+    void start();
+
+private slots:
+    void onScreenAdded(QScreen* screen);
+    void onScreenRemoved(QScreen* screen);
+    void syncScreens();
+
+private:
+    QScreen* scheduleScreen() const;
+    ClassScheduleApp* createInstance(QScreen* screen, bool primary);
+
+    SettingsModel* m_model;
+    AppOptions m_options;
+    ClassScheduleApp* m_primary;                     // 主实例（负责开机自启、卡顿监控）
+    QScreen* m_primaryScreen;
+    QHash<QScreen*, ClassScheduleApp*> m_mirrors;    // 其他屏幕上的镜像
+};
+
+#endif // SCREEN_MANAGER_H
@@ -0,0 +1,577 @@
+﻿#include "SettingsModel.h"
+#include "EventLoopMonitor.h"
+#include "DiagnosticsLog.h"
+#include "ClockSource.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+SettingsModel::SettingsModel(const QString& path, bool persistent, QObject* parent)
+    : QObject(parent),
+    m_path(path.isEmpty() ? defaultPath() : path), m_persistent(persistent),
+    m_writeBlocked(false), m_saveTimer(nullptr)
+{
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(1000);
+    connect(m_saveTimer, &QTimer::timeout, this, &SettingsModel::save);
+}
+
+QString SettingsModel::defaultPath()
+{
+    // 使用应用程序目录的绝对路径
+    return QCoreApplication::applicationDirPath() + "/class_schedule_settings.json";
+}
+
+void SettingsModel::load()
+{
+    EventLoopMonitor::ActivityScope activity("SettingsModel::load");
+    qDebug() << "=== 开始加载设置 ===";
+
+    QString settingsPath = m_path;
+    QFile file(settingsPath);
+
+    qDebug() << "设置文件路径:" << settingsPath;
+
+    m_lastError.clear();
+    m_writeBlocked = false;
+    m_saveTimer->stop();
+
+    if (file.exists() && file.open(QIODevice::ReadOnly)) {
+        qDebug() << "找到设置文件，文件大小:" << file.size();
+
+        QByteArray data = file.readAll();
+        file.close();
+
+        if (!data.isEmpty()) {
+            QJsonParseError parseError;
+            QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+            if (doc.isNull() || !doc.isObject()) {
+                // 记录错误位置并备份原文件；默认设置只在内存中使用，不覆盖原文件，
+                // 用户修正文件后重新加载，或在编辑器中修改后才写回
+                m_lastError = doc.isNull()
+                    ? QString("设置文件解析失败（偏移 %1）：%2").arg(parseError.offset).arg(parseError.errorString())
+                    : QString("设置文件内容不是 JSON 对象");
+                qWarning().noquote() << m_lastError;
+                DiagnosticsLog::instance().write("settings", m_lastError);
+                backupBrokenFile();
+                m_writeBlocked = true;
+            }
+            else {
+                QJsonObject obj = doc.object();
+
+                m_settings.transparency = obj.value("transparency").toDouble(1.0);
+                m_settings.dateFontSize = obj.value("date_font_size").toInt(16);
+                m_settings.timeFontSize = obj.value("time_font_size").toInt(48);
+                m_settings.courseFontSize = obj.value("course_font_size").toInt(28);
+                m_settings.stallThresholdMs = obj.value("stall_threshold_ms").toInt(1000);
+                m_settings.noticeFile = obj.value("notice_file").toString("notices.txt");
+                m_settings.noticeFontSize = obj.value("notice_font_size").toInt(24);
+                m_settings.noticeSpeed = obj.value("notice_speed").toInt(80);
+                m_settings.scheduleScreen = obj.value("schedule_screen").toString();
+                m_settings.mirrorScreens = obj.value("mirror_screens").toBool(false);
+
+                // 时间窗口位置（按屏幕名称）
+                m_settings.clockPositions.clear();
+                QJsonObject clockPositions = obj.value("clock_positions").toObject();
+                for (auto it = clockPositions.constBegin(); it != clockPositions.constEnd(); ++it) {
+                    QJsonObject position = it.value().toObject();
+                    m_settings.clockPositions.insert(it.key(), QPoint(position.value("x").toInt(), position.value("y").toInt()));
+                }
+
+                qDebug() << "透明度设置:" << m_settings.transparency;
+                qDebug() << "日期字体大小:" << m_settings.dateFontSize;
+                qDebug() << "时间字体大小:" << m_settings.timeFontSize;
+                qDebug() << "课程字体大小:" << m_settings.courseFontSize;
+                qDebug() << "卡顿阈值:" << m_settings.stallThresholdMs << "ms";
+
+                // 加载时间段设置（无效的时间段跳过并记录）
+                QJsonArray timeRanges = obj.value("topmost_time_ranges").toArray();
+                m_settings.topmostTimeRanges.clear();
+                qDebug() << "时间段数量:" << timeRanges.size();
+                for (const QJsonValue& value : timeRanges) {
+                    QJsonObject range = value.toObject();
+                    TimeRange tr;
+                    tr.start = range.value("start").toString("08:00");
+                    tr.end = range.value("end").toString("12:00");
+                    if (!isValidTime(tr.start) || !isValidTime(tr.end)) {
+                        m_lastError = QString("忽略无效的置顶时间段: %1 - %2").arg(tr.start, tr.end);
+                        qWarning().noquote() << m_lastError;
+                        DiagnosticsLog::instance().write("settings", m_lastError);
+                        continue;
+                    }
+                    m_settings.topmostTimeRanges.push_back(tr);
+                    qDebug() << "时间段:" << tr.start << "-" << tr.end;
+                }
+
+                // 加载课程表（相同的星期共享同一个模板）
+                QJsonObject schedules = obj.value("schedules").toObject();
+                QJsonObject templates = obj.value("schedule_templates").toObject();
+
+                qDebug() << "JSON中的课程表键:" << schedules.keys() << "模板:" << templates.keys();
+
+                m_settings.schedules.loadJson(schedules, templates);
+
+                QStringList defaultCourses = { "早读", "第一节", "第二节", "第三节", "第四节",
+                                             "第五节", "限时一", "第六节", "第七节", "第八节",
+                                             "限时二", "限时三", "第九节", "第十节", "第十一节" };
+                for (int day = 0; day < ScheduleStore::kDayCount; day++) {
+                    if (m_settings.schedules.hasDay(day)) {
+                        qDebug() << ScheduleStore::weekdayNames()[day] << "的课程数量:" << m_settings.schedules.day(day).size();
+                    }
+                    else {
+                        // 如果没有该星期的课程表，使用默认值
+                        qDebug() << ScheduleStore::weekdayNames()[day] << "没有课程表，使用默认值";
+                        m_settings.schedules.setDay(day, defaultCourses);
+                    }
+                }
+
+                qDebug() << "课表模板数量:" << m_settings.schedules.templateCount();
+
+                // 学期日历
+                m_settings.calendarFile = obj.value("calendar_file").toString();
+                m_settings.termStart = QDate::fromString(obj.value("term_start").toString(), Qt::ISODate);
+                m_settings.termEnd = QDate::fromString(obj.value("term_end").toString(), Qt::ISODate);
+                m_settings.calendarRules.clear();
+                for (const QJsonValue& value : obj.value("calendar_rules").toArray()) {
+                    QJsonObject ruleObj = value.toObject();
+                    CalendarRule rule;
+                    rule.match = ruleObj.value("match").toString();
+                    rule.schedule = ruleObj.value("schedule").toString("none");
+                    if (ruleObj.contains("topmost_time_ranges")) {
+                        rule.overrideTopmost = true;
+                        for (const QJsonValue& rangeValue : ruleObj.value("topmost_time_ranges").toArray()) {
+                            QJsonObject range = rangeValue.toObject();
+                            TimeRange tr(range.value("start").toString(), range.value("end").toString());
+                            if (isValidTime(tr.start) && isValidTime(tr.end)) {
+                                rule.topmostTimeRanges.push_back(tr);
+                            }
+                        }
+                    }
+                    if (!rule.match.isEmpty()) {
+                        m_settings.calendarRules.push_back(rule);
+                    }
+                }
+                loadCalendar();
+
+                // 信息面板
+                m_settings.examName = obj.value("exam_name").toString();
+                m_settings.examDate = QDate::fromString(obj.value("exam_date").toString(), Qt::ISODate);
+                m_settings.dutyRoster.clear();
+                QJsonObject dutyRoster = obj.value("duty_roster").toObject();
+                for (int day = 0; day < ScheduleStore::kDayCount; day++) {
+                    m_settings.dutyRoster.append(dutyRoster.value(ScheduleStore::weekdayNames()[day]).toString());
+                }
+                m_settings.periodTimes.clear();
+                for (const QJsonValue& value : obj.value("period_times").toArray()) {
+                    QJsonObject range = value.toObject();
+                    TimeRange tr(range.value("start").toString(), range.value("end").toString());
+                    if (!isValidTime(tr.start) || !isValidTime(tr.end)) {
+                        qWarning() << "忽略无效的上课时间:" << tr.start << "-" << tr.end;
+                        m_settings.periodTimes.clear();
+                        break; // 与课程行一一对应，缺一项就不再可靠
+                    }
+                    m_settings.periodTimes.push_back(tr);
+                }
+
+                qDebug() << "设置加载成功";
+                emit settingsReloaded();
+                return; // 成功加载，直接返回
+            }
+        }
+    }
+
+    // 如果文件不存在或读取失败，创建默认设置
+    qDebug() << "使用默认设置";
+    createDefaultSettings();
+    emit settingsReloaded();
+}
+
+void SettingsModel::createDefaultSettings()
+{
+    m_settings.transparency = 1.0;
+    m_settings.dateFontSize = 16;
+    m_settings.timeFontSize = 48;
+    m_settings.courseFontSize = 28;
+    m_settings.stallThresholdMs = 1000;
+    m_settings.noticeFile = "notices.txt";
+    m_settings.noticeFontSize = 24;
+    m_settings.noticeSpeed = 80;
+    m_settings.scheduleScreen.clear();
+    m_settings.mirrorScreens = false;
+    m_settings.clockPositions.clear();
+    m_settings.calendarFile.clear();
+    m_settings.termStart = QDate();
+    m_settings.termEnd = QDate();
+    m_settings.calendarRules.clear();
+    m_calendar.clear();
+    m_settings.examName.clear();
+    m_settings.examDate = QDate();
+    m_settings.dutyRoster.clear();
+    m_settings.periodTimes.clear();
+
+    // 默认时间段
+    m_settings.topmostTimeRanges.clear();
+    m_settings.topmostTimeRanges.push_back({ "08:00", "12:00" });
+    m_settings.topmostTimeRanges.push_back({ "14:00", "18:00" });
+
+    // 默认课程表
+    QStringList defaultCourses = { "早读", "第一节", "第二节", "第三节", "第四节",
+                                 "第五节", "限时一", "第六节", "第七节", "第八节",
+                                 "限时二", "限时三", "第九节", "第十节", "第十一节" };
+
+    m_settings.schedules.clear();
+    for (int day = 0; day < ScheduleStore::kDayCount; day++) {
+        m_settings.schedules.setDay(day, defaultCourses);
+    }
+
+    // 保存默认设置（解析失败时被 save() 拦下）
+    save();
+}
+
+void SettingsModel::save()
+{
+    EventLoopMonitor::ActivityScope activity("SettingsModel::save");
+    m_saveTimer->stop();
+    if (!m_persistent) {
+        qDebug() << "当前模式不写回设置文件";
+        return;
+    }
+    if (m_writeBlocked) {
+        qDebug() << "设置文件解析失败，在编辑器中修改前不写回";
+        return;
+    }
+
+    QString settingsPath = m_path;
+    QFile file(settingsPath);
+
+    qDebug() << "保存设置到:" << settingsPath;
+
+    QJsonObject obj;
+    obj["transparency"] = m_settings.transparency;
+    obj["date_font_size"] = m_settings.dateFontSize;
+    obj["time_font_size"] = m_settings.timeFontSize;
+    obj["course_font_size"] = m_settings.courseFontSize;
+    obj["stall_threshold_ms"] = m_settings.stallThresholdMs;
+    obj["notice_file"] = m_settings.noticeFile;
+    obj["notice_font_size"] = m_settings.noticeFontSize;
+    obj["notice_speed"] = m_settings.noticeSpeed;
+    obj["schedule_screen"] = m_settings.scheduleScreen;
+    obj["mirror_screens"] = m_settings.mirrorScreens;
+
+    if (!m_settings.clockPositions.isEmpty()) {
+        QJsonObject clockPositions;
+        for (auto it = m_settings.clockPositions.constBegin(); it != m_settings.clockPositions.constEnd(); ++it) {
+            QJsonObject position;
+            position["x"] = it.value().x();
+            position["y"] = it.value().y();
+            clockPositions[it.key()] = position;
+        }
+        obj["clock_positions"] = clockPositions;
+    }
+
+    // 保存时间段
+    QJsonArray timeRanges;
+    for (const TimeRange& range : m_settings.topmostTimeRanges) {
+        QJsonObject rangeObj;
+        rangeObj["start"] = range.start;
+        rangeObj["end"] = range.end;
+        timeRanges.append(rangeObj);
+    }
+    obj["topmost_time_ranges"] = timeRanges;
+
+    // 保存课程表（共享模板只保存一次）
+    QJsonObject schedules;
+    QJsonObject templates;
+    m_settings.schedules.saveJson(schedules, templates);
+    obj["schedules"] = schedules;
+    if (!templates.isEmpty()) {
+        obj["schedule_templates"] = templates;
+    }
+
+    // 学期日历（未使用时不写入）
+    if (!m_settings.calendarFile.isEmpty()) {
+        obj["calendar_file"] = m_settings.calendarFile;
+        if (m_settings.termStart.isValid()) {
+            obj["term_start"] = m_settings.termStart.toString(Qt::ISODate);
+        }
+        if (m_settings.termEnd.isValid()) {
+            obj["term_end"] = m_settings.termEnd.toString(Qt::ISODate);
+        }
+        QJsonArray rules;
+        for (const CalendarRule& rule : m_settings.calendarRules) {
+            QJsonObject ruleObj;
+            ruleObj["match"] = rule.match;
+            ruleObj["schedule"] = rule.schedule;
+            if (rule.overrideTopmost) {
+                QJsonArray ranges;
+                for (const TimeRange& range : rule.topmostTimeRanges) {
+                    QJsonObject rangeObj;
+                    rangeObj["start"] = range.start;
+                    rangeObj["end"] = range.end;
+                    ranges.append(rangeObj);
+                }
+                ruleObj["topmost_time_ranges"] = ranges;
+            }
+            rules.append(ruleObj);
+        }
+        obj["calendar_rules"] = rules;
+    }
+
+    // 信息面板（未配置时不写入）
+    if (m_settings.examDate.isValid()) {
+        obj["exam_name"] = m_settings.examName;
+        obj["exam_date"] = m_settings.examDate.toString(Qt::ISODate);
+    }
+    QJsonObject dutyRoster;
+    for (int day = 0; day < m_settings.dutyRoster.size() && day < ScheduleStore::kDayCount; day++) {
+        if (!m_settings.dutyRoster[day].isEmpty()) {
+            dutyRoster[ScheduleStore::weekdayNames()[day]] = m_settings.dutyRoster[day];
+        }
+    }
+    if (!dutyRoster.isEmpty()) {
+        obj["duty_roster"] = dutyRoster;
+    }
+    if (!m_settings.periodTimes.empty()) {
+        QJsonArray periodTimes;
+        for (const TimeRange& range : m_settings.periodTimes) {
+            QJsonObject rangeObj;
+            rangeObj["start"] = range.start;
+            rangeObj["end"] = range.end;
+            periodTimes.append(rangeObj);
+        }
+        obj["period_times"] = periodTimes;
+    }
+
+    QJsonDocument doc(obj);
+
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(doc.toJson(QJsonDocument::Indented));
+        file.close();
+        qDebug() << "设置保存成功";
+    }
+    else {
+        qDebug() << "保存设置失败:" << file.errorString();
+        qDebug() << "错误详情:" << file.error();
+    }
+}
+
+void SettingsModel::loadCalendar()
+{
+    m_calendar.clear();
+    if (m_settings.calendarFile.isEmpty()) {
+        return;
+    }
+
+    const QString icsPath = QFileInfo(m_path).absoluteDir().absoluteFilePath(m_settings.calendarFile);
+    // 未配置学期范围时从当前半年的开始（1 月 1 日或 7 月 1 日）起算一年：
+    // 范围每半年才变一次，缓存键不会每天失效，同时总能覆盖今天之后至少半年
+    const QDate today = ClockSource::instance()->currentDate();
+    const QDate halfYearStart(today.year(), today.month() <= 6 ? 1 : 7, 1);
+    const QDate termStart = m_settings.termStart.isValid() ? m_settings.termStart : halfYearStart;
+    const QDate termEnd = m_settings.termEnd.isValid() ? m_settings.termEnd : termStart.addYears(1).addDays(-1);
+
+    QStringList matches;
+    for (const CalendarRule& rule : m_settings.calendarRules) {
+        matches.append(rule.match);
+    }
+
+    // 展开结果缓存在 .ics 旁边，文件不变时启动不再重新解析
+    if (!m_calendar.load(icsPath, termStart, termEnd, matches, icsPath + ".cache.json")) {
+        const QString error = m_calendar.lastError();
+        qWarning().noquote() << "加载学期日历失败:" << error;
+        DiagnosticsLog::instance().write("calendar", error);
+        if (m_lastError.isEmpty()) {
+            m_lastError = error;
+        }
+        return;
+    }
+    qDebug() << "学期日历:" << termStart << "-" << termEnd << "特殊日期数量:" << m_calendar.dayCount();
+}
+
+const CalendarRule* SettingsModel::calendarRuleForDate(const QDate& date) const
+{
+    const int rule = m_calendar.ruleForDate(date);
+    if (rule < 0 || rule >= int(m_settings.calendarRules.size())) {
+        return nullptr;
+    }
+    return &m_settings.calendarRules[rule];
+}
+
+bool SettingsModel::hasCoursesForDate(const QDate& date) const
+{
+    return calendarRuleForDate(date) != nullptr || m_settings.schedules.hasDay(date.dayOfWeek() - 1);
+}
+
+const QStringList& SettingsModel::coursesForDate(const QDate& date) const
+{
+    static const QStringList empty;
+    if (const CalendarRule* rule = calendarRuleForDate(date)) {
+        if (rule->schedule == "none") {
+            return empty;
+        }
+        // 调休等情况可以指定按某个星期的课表上课
+        const int weekday = ScheduleStore::weekdayIndex(rule->schedule);
+        if (weekday >= 0) {
+            return m_settings.schedules.day(weekday);
+        }
+        if (m_settings.schedules.hasTemplate(rule->schedule)) {
+            return m_settings.schedules.templateCourses(rule->schedule);
+        }
+        qDebug() << "日历规则引用了不存在的课表:" << rule->schedule;
+    }
+    return m_settings.schedules.day(date.dayOfWeek() - 1);
+}
+
+const std::vector<TimeRange>& SettingsModel::topmostRangesForDate(const QDate& date) const
+{
+    static const std::vector<TimeRange> empty;
+    if (const CalendarRule* rule = calendarRuleForDate(date)) {
+        if (rule->schedule == "none") {
+            return empty;
+        }
+        if (rule->overrideTopmost) {
+            return rule->topmostTimeRanges;
+        }
+    }
+    return m_settings.topmostTimeRanges;
+}
+
+void SettingsModel::backupBrokenFile()
+{
+    if (!m_persistent) {
+        return;
+    }
+
+    QFileInfo info(m_path);
+    QString backupPath = info.absoluteDir().absoluteFilePath(QString("%1.broken-%2.%3")
+        .arg(info.completeBaseName(), QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"), info.suffix()));
+    if (QFile::copy(m_path, backupPath)) {
+        m_lastError += QString("\n原文件已备份到 %1").arg(backupPath);
+        qWarning() << "损坏的设置文件已备份到:" << backupPath;
+    }
+    else {
+        qWarning() << "备份损坏的设置文件失败:" << backupPath;
+    }
+}
+
+bool SettingsModel::isValidTime(const QString& text)
+{
+    return text.size() == 5 && QTime::fromString(text, "HH:mm").isValid();
+}
+
+void SettingsModel::scheduleSave(bool userEdit)
+{
+    if (userEdit && m_writeBlocked) {
+        // 用户在编辑器中做了修改，视为确认用当前设置替换损坏的文件（原文件已备份）
+        m_writeBlocked = false;
+        m_lastError.clear();
+    }
+    if (m_persistent) {
+        m_saveTimer->start(); // 重新计时，连续编辑只写一次
+    }
+}
+
+void SettingsModel::flush()
+{
+    if (m_saveTimer->isActive()) {
+        save();
+    }
+}
+
+void SettingsModel::setCourse(int day, int row, const QString& name)
+{
+    QStringList courses = m_settings.schedules.day(day);
+    if (row < 0 || row >= courses.size() || courses[row] == name) {
+        return;
+    }
+
+    // 其他星期共享的模板不受影响（ScheduleStore 按内容重新查找模板）
+    courses[row] = name;
+    m_settings.schedules.setDay(day, courses);
+    emit courseChanged(day, row);
+    scheduleSave();
+}
+
+void SettingsModel::insertCourse(int day, int row, const QString& name)
+{
+    if (day < 0 || day >= ScheduleStore::kDayCount) {
+        return;
+    }
+
+    QStringList courses = m_settings.schedules.day(day);
+    courses.insert(qBound(0, row, int(courses.size())), name);
+    m_settings.schedules.setDay(day, courses);
+    emit dayChanged(day);
+    scheduleSave();
+}
+
+void SettingsModel::removeCourse(int day, int row)
+{
+    QStringList courses = m_settings.schedules.day(day);
+    if (row < 0 || row >= courses.size()) {
+        return;
+    }
+
+    courses.removeAt(row);
+    m_settings.schedules.setDay(day, courses);
+    emit dayChanged(day);
+    scheduleSave();
+}
+
+void SettingsModel::setCourseFontSize(int size)
+{
+    if (size <= 0 || size == m_settings.courseFontSize) {
+        return;
+    }
+
+    m_settings.courseFontSize = size;
+    emit courseFontSizeChanged(size);
+    scheduleSave();
+}
+
+void SettingsModel::setTransparency(double transparency)
+{
+    transparency = qBound(0.1, transparency, 1.0);
+    if (qFuzzyCompare(transparency, m_settings.transparency)) {
+        return;
+    }
+
+    m_settings.transparency = transparency;
+    emit transparencyChanged(transparency);
+    scheduleSave();
+}
+
+bool SettingsModel::setTopmostTimeRanges(const std::vector<TimeRange>& ranges, QString* error)
+{
+    for (const TimeRange& range : ranges) {
+        if (!isValidTime(range.start) || !isValidTime(range.end)) {
+            if (error) {
+                *error = QString("无效的时间段: %1 - %2（格式应为 HH:mm）").arg(range.start, range.end);
+            }
+            return false;
+        }
+    }
+
+    m_settings.topmostTimeRanges = ranges;
+    emit topmostTimeRangesChanged();
+    scheduleSave();
+    return true;
+}
+
+void SettingsModel::setClockPosition(const QString& screenName, const QPoint& offset)
+{
+    auto it = m_settings.clockPositions.constFind(screenName);
+    if (it != m_settings.clockPositions.constEnd() && it.value() == offset) {
+        return;
+    }
+
+    m_settings.clockPositions.insert(screenName, offset);
+    scheduleSave(false);
+}
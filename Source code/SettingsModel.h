@@ -0,0 +1,131 @@
+﻿#ifndef SETTINGS_MODEL_H
+#define SETTINGS_MODEL_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "ScheduleStore.h"
+#include "TermCalendar.h"
+#include <QDate>
+#include <QHash>
+#include <QPoint>
+#include <vector>
+
+struct TimeRange {
+    QString start;
+    QString end;
+
+    TimeRange(const QString& s = "", const QString& e = "") : start(s), end(e) {}
+};
+
+// 日历规则：.ics 中标题或分类包含 match 的日期改用 schedule 对应的课表
+// （模板名、英文星期名，或 "none" 表示不上课且不置顶）
+struct CalendarRule {
+    QString match;
+    QString schedule;
+    bool overrideTopmost = false;             // 是否使用自己的置顶时间段
+    std::vector<TimeRange> topmostTimeRanges;
+};
+
+struct ScheduleSettings {
+    double transparency = 1.0;
+    int dateFontSize = 16;
+    int timeFontSize = 48;
+    int courseFontSize = 28;
+    int stallThresholdMs = 1000; // 事件循环卡顿记录阈值
+    QString noticeFile = "notices.txt"; // 滚动通知文件（相对设置文件所在目录）
+    int noticeFontSize = 24;
+    int noticeSpeed = 80;        // 滚动速度（像素/秒）
+    QString scheduleScreen;      // 课程表所在屏幕名称，为空时使用主屏幕
+    bool mirrorScreens = false;  // 是否在其他屏幕上显示镜像
+    QHash<QString, QPoint> clockPositions; // 各屏幕上用户拖动后的时间窗口位置（相对屏幕左上角）
+    std::vector<TimeRange> topmostTimeRanges;
+    ScheduleStore schedules; // 按星期下标索引，相同的星期共享模板
+    QString calendarFile;    // 学期日历 .ics（相对设置文件所在目录），为空时不使用
+    QDate termStart;         // 学期范围，未设置时从当前半年的开始（1 月 1 日或 7 月 1 日）起一年
+    QDate termEnd;
+    std::vector<CalendarRule> calendarRules;
+    // 信息面板（未配置的面板不显示）
+    QString examName;        // 考试倒计时
+    QDate examDate;
+    QStringList dutyRoster;  // 按星期下标的值日安排
+    std::vector<TimeRange> periodTimes; // 与课程行对应的上下课时间
+};
+
+// 设置模型：所有窗口实例（包括其他屏幕上的镜像）共用同一份设置，
+// 负责读写 class_schedule_settings.json。
+// 编辑器通过细粒度的修改函数改动设置，每次修改只发出对应的信号，
+// 显示端只更新受影响的课程行或窗口属性；写回文件经过短暂延迟合并。
+class SettingsModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    // path 为空时使用程序目录下的 class_schedule_settings.json；
+    // persistent 为 false 时不写回文件（模拟、快照等模式）
+    explicit SettingsModel(const QString& path = QString(), bool persistent = true, QObject* parent = nullptr);
+
+    static QString defaultPath();
+
+    const ScheduleSettings& settings() const { return m_settings; }
+    QString filePath() const { return m_path; }
+    bool isPersistent() const { return m_persistent; }
+
+    void load();
+    void save();
+
+    // 最近一次加载失败的原因（解析错误等），成功时为空；
+    // 解析失败时默认设置只保留在内存中，直到用户在编辑器中修改后才写回
+    QString lastError() const { return m_lastError; }
+
+    // HH:mm 格式校验
+    static bool isValidTime(const QString& text);
+
+    // 按日期查询（日历规则优先，其次按星期）
+    bool hasCoursesForDate(const QDate& date) const;
+    const QStringList& coursesForDate(const QDate& date) const;
+    const std::vector<TimeRange>& topmostRangesForDate(const QDate& date) const;
+    // 该日期命中的日历规则，没有时为 nullptr
+    const CalendarRule* calendarRuleForDate(const QDate& date) const;
+
+    // 细粒度修改，修改后延迟写回文件
+    void setCourse(int day, int row, const QString& name);
+    void insertCourse(int day, int row, const QString& name);
+    void removeCourse(int day, int row);
+    void setCourseFontSize(int size);
+    void setTransparency(double transparency);
+    // 时间段中有无效时间时不做修改并返回 false
+    bool setTopmostTimeRanges(const std::vector<TimeRange>& ranges, QString* error = nullptr);
+    void setClockPosition(const QString& screenName, const QPoint& offset);
+
+    // 立即写回尚未保存的修改
+    void flush();
+
+signals:
+    // 设置被重新加载
+    void settingsReloaded();
+    // 某一天的一行课程名称改变
+    void courseChanged(int day, int row);
+    // 某一天的课程行数改变
+    void dayChanged(int day);
+    void courseFontSizeChanged(int size);
+    void transparencyChanged(double transparency);
+    void topmostTimeRangesChanged();
+
+private:
+    void createDefaultSettings();
+    void backupBrokenFile();
+    void loadCalendar();
+    // userEdit 为 false 时（如拖动时钟）不解除解析失败后的写回保护
+    void scheduleSave(bool userEdit = true);
+
+    ScheduleSettings m_settings;
+    QString m_path;
+    bool m_persistent;
+    QString m_lastError;
+    bool m_writeBlocked;  // 设置文件解析失败后，在编辑器中修改前不写回，避免默认设置覆盖原文件
+    QTimer* m_saveTimer; // 合并连续编辑的写回
+    TermCalendar m_calendar;
+};
+
+#endif // SETTINGS_MODEL_H
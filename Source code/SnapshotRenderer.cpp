@@ -0,0 +1,172 @@
+﻿#include "SnapshotRenderer.h"
+#include "ClassScheduleApp.h"
+#include "TimeWindow.h"
+#include "ClockSource.h"
+#include <QApplication>
+#include <QScreen>
+#include <QPainter>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+
+bool SnapshotRenderer::loadJobs(const QString& path, const QString& outputDir, std::vector<Job>& jobs, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("无法打开任务文件 %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull() || !doc.isArray()) {
+        *error = QString("任务文件格式错误: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    // 任务中的相对路径以任务文件所在目录为基准
+    const QDir baseDir = QFileInfo(path).absoluteDir();
+    const QJsonArray array = doc.array();
+    for (int i = 0; i < array.size(); i++) {
+        const QJsonObject obj = array[i].toObject();
+        Job job;
+        job.configPath = baseDir.absoluteFilePath(obj.value("config").toString());
+        job.time = QDateTime::fromString(obj.value("time").toString(), Qt::ISODate);
+        if (!job.time.isValid()) {
+            *error = QString("第 %1 个任务的时间无效: %2").arg(i + 1).arg(obj.value("time").toString());
+            return false;
+        }
+        job.outputPath = obj.contains("output")
+            ? baseDir.absoluteFilePath(obj.value("output").toString())
+            : defaultOutputPath(outputDir, job.configPath, job.time);
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+QString SnapshotRenderer::defaultOutputPath(const QString& outputDir, const QString& configPath, const QDateTime& time)
+{
+    return QDir(outputDir).absoluteFilePath(QString("%1_%2.png")
+        .arg(QFileInfo(configPath).completeBaseName(), time.toString("yyyyMMdd_HHmmss")));
+}
+
+SnapshotRenderer::SnapshotRenderer(QObject* parent)
+    : QObject(parent)
+{
+}
+
+int SnapshotRenderer::run(std::vector<Job> jobs)
+{
+    if (jobs.empty()) {
+        qWarning() << "没有快照任务";
+        return 1;
+    }
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    // 同一设置文件的任务放在一起，复用同一组窗口
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        return a.configPath < b.configPath;
+    });
+
+    VirtualClock clock(jobs.front().time);
+    ClockSource::setInstance(&clock);
+
+    AppOptions appOptions;
+    appOptions.autoStart = false;
+    appOptions.persistSettings = false;
+    appOptions.monitorEventLoop = false;
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    std::atomic<int> failures(0);
+    QSemaphore pendingImages(qMax(2, pool->maxThreadCount()));
+    ClassScheduleApp* app = nullptr;
+
+    for (const Job& job : jobs) {
+        if (!app || appOptions.settingsPath != job.configPath) {
+            delete app;
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+            if (!QFileInfo::exists(job.configPath)) {
+                qWarning() << "设置文件不存在，将使用默认设置:" << job.configPath;
+            }
+            clock.setDateTime(job.time);
+            appOptions.settingsPath = job.configPath;
+            app = new ClassScheduleApp(appOptions);
+        }
+
+        // 按目标时刻推进状态：星期变化重建课程表、按时间段切换显示模式
+        clock.setDateTime(job.time);
+        app->updateDateTime();
+        app->checkTopmostStatus();
+        if (app->timeWindow) {
+            app->timeWindow->updateDateTime();
+        }
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QCoreApplication::processEvents();
+
+        QImage image = renderBoard(app);
+        const QString outputPath = job.outputPath;
+        QDir().mkpath(QFileInfo(outputPath).absolutePath());
+
+        // PNG 编码较慢，交给线程池；限制排队的整屏图像数量，避免内存随任务数增长
+        pendingImages.acquire();
+        pool->start([image, outputPath, &failures, &pendingImages]() {
+            if (!image.save(outputPath, "PNG")) {
+                failures++;
+                qWarning() << "保存快照失败:" << outputPath;
+            }
+            pendingImages.release();
+        });
+    }
+
+    delete app;
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    pool->waitForDone();
+    ClockSource::setInstance(nullptr);
+
+    qInfo() << "快照完成:" << jobs.size() << "张，失败" << failures.load()
+        << "张，耗时" << batchTimer.elapsed() << "ms";
+    return failures.load() == 0 ? 0 : 1;
+}
+
+QImage SnapshotRenderer::renderBoard(ClassScheduleApp* app) const
+{
+    QScreen* screen = app->screen() ? app->screen() : QApplication::primaryScreen();
+    const QRect area = screen->geometry();
+    const qreal dpr = screen->devicePixelRatio();
+
+    QImage image(area.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(QColor(235, 235, 235)); // 近似白板桌面背景
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // 按窗口实际位置和透明度合成，与大屏上看到的一致
+    auto drawWindow = [&painter, &area](QWidget* window) {
+        if (!window || !window->isVisible()) {
+            return;
+        }
+        painter.save();
+        painter.setOpacity(window->windowOpacity());
+        window->render(&painter, window->geometry().topLeft() - area.topLeft(), QRegion(), QWidget::DrawChildren);
+        painter.restore();
+    };
+
+    drawWindow(app);
+    drawWindow(app->timeWindow);
+    painter.end();
+
+    return image;
+}
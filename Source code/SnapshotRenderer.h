@@ -0,0 +1,41 @@
+﻿#ifndef SNAPSHOT_RENDERER_H
+#define SNAPSHOT_RENDERER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+#include <vector>
+
+class ClassScheduleApp;
+
+// 批量离屏快照：在 offscreen 平台下按 (设置文件, 时间) 渲染课程表和时间窗口到 PNG，
+// 用于在下发课表前预览各教室大屏在指定时刻的显示效果。
+// 控件只能在 GUI 线程绘制，PNG 编码和写文件放到线程池并行完成；
+// 同一设置文件的任务复用同一组窗口，字体和字形缓存在整个批次内共享。
+class SnapshotRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Job {
+        QString configPath;
+        QDateTime time;
+        QString outputPath;
+    };
+
+    // 从 JSON 任务文件读取：[{"config": "...", "time": "2025-09-01T07:55:00", "output": "..."}]
+    // output 省略时按设置文件名和时间生成到 outputDir
+    static bool loadJobs(const QString& path, const QString& outputDir, std::vector<Job>& jobs, QString* error);
+    static QString defaultOutputPath(const QString& outputDir, const QString& configPath, const QDateTime& time);
+
+    explicit SnapshotRenderer(QObject* parent = nullptr);
+
+    // 渲染全部任务，返回进程退出码（有失败任务时非 0）
+    int run(std::vector<Job> jobs);
+
+private:
+    QImage renderBoard(ClassScheduleApp* app) const;
+};
+
+#endif // SNAPSHOT_RENDERER_H
@@ -0,0 +1,229 @@
+﻿#define NOMINMAX
+#include "SoakTest.h"
+#include "ClassScheduleApp.h"
+#include "TimeWindow.h"
+#include "ClockSource.h"
+#include "AllocationCounter.h"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QWidget>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+SoakTest::SoakTest(ClassScheduleApp* app, VirtualClock* clock, const Options& options, QObject* parent)
+    : QObject(parent),
+    m_app(app), m_clock(clock), m_options(options)
+{
+}
+
+int SoakTest::run()
+{
+    qInfo() << "=== 开始浸泡测试 ===" << "模拟天数:" << m_options.days;
+
+    // 停掉真实定时器，由测试循环按模拟时间驱动
+    m_app->datetimeTimer->stop();
+    m_app->topmostCheckTimer->stop();
+    m_app->pixelShiftTimer->stop();
+    if (m_app->timeWindow) {
+        m_app->timeWindow->datetimeTimer->stop();
+    }
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+    dispatchPendingEvents();
+    m_samples.push_back(takeSample(0));
+
+    const int totalMinutes = m_options.days * 24 * 60;
+    const int baselineMinute = qMin(totalMinutes, m_options.warmupDays * 24 * 60);
+    int baselineIndex = -1;
+
+    for (int minute = 1; minute <= totalMinutes; minute++) {
+        m_clock->advance(60 * 1000);
+
+        // 正常的时钟刷新和星期检查
+        m_app->updateDateTime();
+        if (m_app->timeWindow) {
+            m_app->timeWindow->updateDateTime();
+        }
+
+        // 加速执行容易泄漏的路径
+        if (minute % qMax(1, m_options.rebuildEveryMinutes) == 0) {
+            m_app->createCourseList();
+        }
+        if (minute % qMax(1, m_options.toggleEveryMinutes) == 0) {
+            m_app->toggleDisplayMode(!m_app->currentTopmostState);
+        }
+        if (minute % qMax(1, m_options.pixelShiftEveryMinutes) == 0) {
+            m_app->pixelShift();
+        }
+
+        dispatchPendingEvents();
+
+        // 每个模拟小时采样一次
+        if (minute % 60 == 0) {
+            m_samples.push_back(takeSample(wallTimer.elapsed()));
+            if (minute == baselineMinute) {
+                baselineIndex = int(m_samples.size()) - 1;
+            }
+            if (minute % (24 * 60) == 0) {
+                const Sample& s = m_samples.back();
+                qInfo() << "第" << minute / (24 * 60) << "天: RSS" << s.rssKb << "KB, 私有" << s.privateKb
+                    << "KB, 存活分配" << s.liveAllocations
+                    << ", QObject" << s.objects << ", 句柄" << s.handles << ", GDI" << s.gdiObjects;
+            }
+        }
+    }
+
+    writeReport();
+
+    bool passed = true;
+    if (baselineIndex >= 0 && baselineIndex < int(m_samples.size()) - 1) {
+        passed = checkGrowth(m_samples[baselineIndex], m_samples.back());
+    }
+    else {
+        qWarning() << "模拟时间不足以越过预热期，未做增长判定";
+    }
+
+    qInfo() << "=== 浸泡测试" << (passed ? "通过" : "失败") << "=== 耗时" << wallTimer.elapsed() << "ms";
+    for (const QString& failure : m_failures) {
+        qWarning().noquote() << failure;
+    }
+    return passed ? 0 : 1;
+}
+
+void SoakTest::dispatchPendingEvents()
+{
+    // deleteLater 在没有事件循环时不会自动执行，这里手动触发
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QCoreApplication::processEvents();
+}
+
+SoakTest::Sample SoakTest::takeSample(qint64 wallMs) const
+{
+    Sample sample;
+    sample.simulatedTime = m_clock->now();
+    sample.wallMs = wallMs;
+    sample.rssKb = residentSetKb();
+    const qint64 privateBytes = AllocationCounter::privateBytes();
+    sample.privateKb = privateBytes < 0 ? -1 : privateBytes / 1024;
+    sample.heapBytes = AllocationCounter::heapBytes();
+    if (AllocationCounter::isEnabled()) {
+        sample.liveAllocations = AllocationCounter::liveAllocations();
+        sample.totalAllocations = AllocationCounter::allocations();
+    }
+    sample.objects = countObjects();
+    sample.widgets = QApplication::allWidgets().size();
+    nativeHandleCounts(sample.handles, sample.gdiObjects, sample.userObjects);
+    return sample;
+}
+
+bool SoakTest::checkGrowth(const Sample& baseline, const Sample& last)
+{
+    auto check = [this](const char* name, qint64 before, qint64 after, qint64 limit) {
+        if (before < 0 || after < 0) {
+            return; // 平台不支持该项
+        }
+        const qint64 growth = after - before;
+        qInfo() << name << "增长:" << growth << "(上限" << limit << ")";
+        if (growth > limit) {
+            m_failures.append(QString("%1 增长 %2 超过上限 %3 (%4 -> %5)")
+                .arg(QString::fromLatin1(name)).arg(growth).arg(limit).arg(before).arg(after));
+        }
+    };
+
+    check("rss_kb", baseline.rssKb, last.rssKb, m_options.maxRssGrowthKb);
+    check("private_kb", baseline.privateKb, last.privateKb, m_options.maxPrivateGrowthKb);
+    check("live_allocations", baseline.liveAllocations, last.liveAllocations, m_options.maxLiveAllocationGrowth);
+    check("qobjects", baseline.objects, last.objects, m_options.maxObjectGrowth);
+    check("widgets", baseline.widgets, last.widgets, m_options.maxObjectGrowth);
+    check("handles", baseline.handles, last.handles, m_options.maxHandleGrowth);
+    check("gdi_objects", baseline.gdiObjects, last.gdiObjects, m_options.maxHandleGrowth);
+    check("user_objects", baseline.userObjects, last.userObjects, m_options.maxHandleGrowth);
+
+    return m_failures.isEmpty();
+}
+
+void SoakTest::writeReport() const
+{
+    if (m_options.reportPath.isEmpty()) {
+        return;
+    }
+
+    QFile file(m_options.reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "保存浸泡测试报告失败:" << file.errorString();
+        return;
+    }
+
+    QTextStream out(&file);
+    out << "simulated_time,wall_ms,rss_kb,private_kb,heap_bytes,live_allocations,total_allocations,"
+           "qobjects,widgets,handles,gdi_objects,user_objects\n";
+    for (const Sample& s : m_samples) {
+        out << s.simulatedTime.toString(Qt::ISODate) << ',' << s.wallMs << ',' << s.rssKb << ','
+            << s.privateKb << ',' << s.heapBytes << ',' << s.liveAllocations << ',' << s.totalAllocations << ','
+            << s.objects << ',' << s.widgets << ',' << s.handles << ',' << s.gdiObjects << ','
+            << s.userObjects << '\n';
+    }
+    file.close();
+    qInfo() << "浸泡测试采样已保存:" << m_options.reportPath;
+}
+
+qint64 SoakTest::residentSetKb()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize / 1024);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#else
+    return -1;
+#endif
+}
+
+void SoakTest::nativeHandleCounts(int& handles, int& gdiObjects, int& userObjects)
+{
+    handles = gdiObjects = userObjects = -1;
+#ifdef Q_OS_WIN
+    DWORD handleCount = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handleCount)) {
+        handles = int(handleCount);
+    }
+    gdiObjects = int(GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+    userObjects = int(GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS));
+#elif defined(Q_OS_LINUX)
+    // 打开的文件描述符数量
+    handles = QDir("/proc/self/fd").entryList(QDir::Files | QDir::System | QDir::NoDotAndDotDot).size();
+#endif
+}
+
+int SoakTest::countObjects()
+{
+    // 应用对象及所有顶层窗口下的对象树
+    int count = 1 + qApp->findChildren<QObject*>().size();
+    for (QWidget* window : QApplication::topLevelWidgets()) {
+        if (!window->parent()) {
+            count += 1 + window->findChildren<QObject*>().size();
+        }
+    }
+    return count;
+}
@@ -0,0 +1,71 @@
+﻿#ifndef SOAK_TEST_H
+#define SOAK_TEST_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+class ClassScheduleApp;
+class VirtualClock;
+
+// 长时间运行（浸泡）测试：用虚拟时钟加速反复执行课程表重建、显示模式切换和防烧屏偏移，
+// 定期采样常驻内存、堆分配、QObject 数量和原生句柄数量，增长超过阈值时判定失败。
+class SoakTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int days = 30;                    // 模拟天数
+        int rebuildEveryMinutes = 1;      // 每隔多少模拟分钟强制重建课程表
+        int toggleEveryMinutes = 1;       // 每隔多少模拟分钟切换显示模式
+        int pixelShiftEveryMinutes = 5;   // 每隔多少模拟分钟执行防烧屏偏移
+        int warmupDays = 1;               // 预热天数，之后的采样作为基线
+        qint64 maxRssGrowthKb = 32 * 1024;
+        qint64 maxPrivateGrowthKb = 32 * 1024; // 进程私有字节（泄漏判断的主要依据）
+        qint64 maxLiveAllocationGrowth = 20000;
+        int maxObjectGrowth = 50;
+        int maxHandleGrowth = 32;
+        QString reportPath;               // CSV 采样输出路径，为空则只打印
+    };
+
+    SoakTest(ClassScheduleApp* app, VirtualClock* clock, const Options& options, QObject* parent = nullptr);
+
+    // 运行测试，返回进程退出码（资源增长超过阈值时非 0）
+    int run();
+
+private:
+    struct Sample {
+        QDateTime simulatedTime;
+        qint64 wallMs = 0;
+        qint64 rssKb = -1;
+        qint64 privateKb = -1;
+        qint64 heapBytes = -1;
+        qint64 liveAllocations = -1;    // 未启用分配计数时为 -1
+        quint64 totalAllocations = 0;
+        int objects = 0;
+        int widgets = 0;
+        int handles = -1;
+        int gdiObjects = -1;
+        int userObjects = -1;
+    };
+
+    Sample takeSample(qint64 wallMs) const;
+    void dispatchPendingEvents();
+    bool checkGrowth(const Sample& baseline, const Sample& last);
+    void writeReport() const;
+
+    static qint64 residentSetKb();
+    static void nativeHandleCounts(int& handles, int& gdiObjects, int& userObjects);
+    static int countObjects();
+
+    ClassScheduleApp* m_app;
+    VirtualClock* m_clock;
+    Options m_options;
+    std::vector<Sample> m_samples;
+    QStringList m_failures;
+};
+
+#endif // SOAK_TEST_H
@@ -0,0 +1,490 @@
+﻿#include "TermCalendar.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimeZone>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// 缓存格式版本，展开逻辑变化时递增
+const int kCacheVersion = 2;
+// 没有 COUNT/UNTIL 的月/年重复最多向后展开的次数
+const int kMaxPeriods = 2400;
+}
+
+TermCalendar::TermCalendar()
+{
+}
+
+void TermCalendar::clear()
+{
+    m_days.clear();
+    m_lastError.clear();
+}
+
+bool TermCalendar::load(const QString& icsPath, const QDate& termStart, const QDate& termEnd,
+    const QStringList& matches, const QString& cachePath)
+{
+    clear();
+
+    QFileInfo info(icsPath);
+    if (!info.exists()) {
+        m_lastError = QString("日历文件不存在: %1").arg(icsPath);
+        return false;
+    }
+    if (!termStart.isValid() || !termEnd.isValid() || termEnd < termStart) {
+        m_lastError = QString("无效的学期范围: %1 - %2").arg(termStart.toString(Qt::ISODate), termEnd.toString(Qt::ISODate));
+        return false;
+    }
+
+    // 文件、学期范围和规则都相同时缓存有效
+    const QByteArray rulesHash = QCryptographicHash::hash(matches.join('\n').toUtf8(), QCryptographicHash::Sha1).toHex();
+    const QString key = QString("%1|%2|%3|%4|%5|%6").arg(kCacheVersion).arg(info.size())
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(termStart.toString(Qt::ISODate), termEnd.toString(Qt::ISODate), QString::fromLatin1(rulesHash));
+
+    if (!cachePath.isEmpty() && readCache(cachePath, key)) {
+        qDebug() << "使用日历缓存:" << cachePath << "天数:" << m_days.size();
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!parse(icsPath, termStart, termEnd, matches)) {
+        m_days.clear();
+        return false;
+    }
+
+    // 按日期排序，同一天只保留下标最小（优先级最高）的规则
+    std::sort(m_days.begin(), m_days.end());
+    m_days.erase(std::unique(m_days.begin(), m_days.end(),
+        [](const std::pair<qint64, int>& a, const std::pair<qint64, int>& b) { return a.first == b.first; }),
+        m_days.end());
+    m_days.shrink_to_fit();
+
+    qDebug() << "日历展开完成:" << icsPath << "天数:" << m_days.size() << "耗时" << timer.elapsed() << "ms";
+
+    if (!cachePath.isEmpty()) {
+        writeCache(cachePath, key);
+    }
+    return true;
+}
+
+int TermCalendar::ruleForDate(const QDate& date) const
+{
+    const qint64 day = date.toJulianDay();
+    auto it = std::lower_bound(m_days.begin(), m_days.end(), std::make_pair(day, -1));
+    if (it != m_days.end() && it->first == day) {
+        return it->second;
+    }
+    return -1;
+}
+
+bool TermCalendar::parse(const QString& icsPath, const QDate& termStart, const QDate& termEnd, const QStringList& matches)
+{
+    QFile file(icsPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_lastError = QString("无法打开日历文件: %1").arg(file.errorString());
+        return false;
+    }
+
+    bool inEvent = false;
+    bool allDayEnd = true;
+    QString endValue;
+    Event event;
+    int eventCount = 0;
+    int matchedCount = 0;
+
+    // 处理一条已展开折行的内容行
+    auto processLine = [&](const QString& line) {
+        if (line.isEmpty()) {
+            return;
+        }
+        if (line == "BEGIN:VEVENT") {
+            inEvent = true;
+            event = Event();
+            endValue.clear();
+            return;
+        }
+        if (!inEvent) {
+            return;
+        }
+        if (line == "END:VEVENT") {
+            inEvent = false;
+            eventCount++;
+            if (!event.start.isValid()) {
+                return;
+            }
+
+            // 全天事件的 DTEND 不包含当天；带时间的事件占用到结束当天
+            if (!endValue.isEmpty()) {
+                QDate end = parseDate(endValue, &allDayEnd);
+                if (end.isValid() && !allDayEnd && !endValue.mid(9, 6).startsWith("000000")) {
+                    end = end.addDays(1);
+                }
+                event.end = end;
+            }
+            if (!event.end.isValid() || event.end <= event.start) {
+                event.end = event.start.addDays(1);
+            }
+
+            for (int i = 0; i < matches.size(); i++) {
+                if (event.summary.contains(matches[i]) || event.categories.contains(matches[i])) {
+                    matchedCount++;
+                    expand(event, i, termStart, termEnd);
+                    break;
+                }
+            }
+            return;
+        }
+
+        const int colon = line.indexOf(':');
+        if (colon <= 0) {
+            return;
+        }
+        const QString name = line.left(colon).section(';', 0, 0).toUpper();
+        const QString value = line.mid(colon + 1);
+
+        if (name == "DTSTART") {
+            event.start = parseDate(value);
+        }
+        else if (name == "DTEND") {
+            endValue = value;
+        }
+        else if (name == "DURATION") {
+            // 只处理按天/周的时长（P1D、P2W）
+            int days = 0;
+            if (value.startsWith("P") && value.endsWith("D")) {
+                days = value.mid(1, value.size() - 2).toInt();
+            }
+            else if (value.startsWith("P") && value.endsWith("W")) {
+                days = value.mid(1, value.size() - 2).toInt() * 7;
+            }
+            if (days > 0 && event.start.isValid()) {
+                event.end = event.start.addDays(days);
+            }
+        }
+        else if (name == "SUMMARY") {
+            event.summary = QString(value).replace("\\,", ",").replace("\\;", ";").replace("\\n", " ");
+        }
+        else if (name == "CATEGORIES") {
+            event.categories = QString(value).replace("\\,", ",");
+        }
+        else if (name == "RRULE") {
+            event.rrule = value;
+        }
+        else if (name == "EXDATE") {
+            for (const QString& part : value.split(',')) {
+                QDate date = parseDate(part);
+                if (date.isValid()) {
+                    event.exdates.push_back(date);
+                }
+            }
+        }
+    };
+
+    // 逐行读取，按 RFC 5545 展开以空格或制表符开头的折行。
+    // 折行可能切在多字节 UTF-8 字符中间，先拼接原始字节，整行拼好后再解码
+    QByteArray pending;
+    while (!file.atEnd()) {
+        QByteArray raw = file.readLine();
+        while (raw.endsWith('\n') || raw.endsWith('\r')) {
+            raw.chop(1);
+        }
+        if (!raw.isEmpty() && (raw[0] == ' ' || raw[0] == '\t')) {
+            pending.append(raw.constData() + 1, raw.size() - 1);
+            continue;
+        }
+        processLine(QString::fromUtf8(pending));
+        pending = raw;
+    }
+    processLine(QString::fromUtf8(pending));
+
+    qDebug() << "日历事件数量:" << eventCount << "命中规则:" << matchedCount;
+    return true;
+}
+
+void TermCalendar::expand(const Event& event, int rule, const QDate& termStart, const QDate& termEnd)
+{
+    const int span = int(event.start.daysTo(event.end));
+    if (event.rrule.isEmpty()) {
+        addSpan(event.start, span, rule, termStart, termEnd);
+        return;
+    }
+
+    QString freq;
+    int interval = 1;
+    int count = -1;
+    QDate until;
+    std::vector<int> byDay;
+    std::vector<std::pair<int, int>> byOrdinalDay; // (序号, 星期)，序号 0 表示每周，负数从月末倒数
+    std::vector<int> byMonthDay;
+    QStringList unsupported;
+    static const QStringList dayCodes = { "MO", "TU", "WE", "TH", "FR", "SA", "SU" };
+    for (const QString& part : event.rrule.split(';')) {
+        const QString key = part.section('=', 0, 0).toUpper();
+        const QString value = part.section('=', 1);
+        if (key == "FREQ") {
+            freq = value.toUpper();
+        }
+        else if (key == "INTERVAL") {
+            interval = qMax(1, value.toInt());
+        }
+        else if (key == "COUNT") {
+            count = value.toInt();
+        }
+        else if (key == "UNTIL") {
+            until = parseDate(value);
+        }
+        else if (key == "BYDAY") {
+            for (const QString& code : value.split(',')) {
+                // 序号前缀（如 1MO、-1FR）只对 MONTHLY 有意义，WEEKLY 中出现时按不支持处理
+                const int index = dayCodes.indexOf(code.right(2).toUpper());
+                const QString prefix = code.left(code.size() - 2);
+                bool ok = true;
+                const int ordinal = prefix.isEmpty() ? 0 : prefix.toInt(&ok);
+                if (index < 0 || !ok || qAbs(ordinal) > 5) {
+                    unsupported << part;
+                    break;
+                }
+                byOrdinalDay.emplace_back(ordinal, index + 1);
+                if (ordinal == 0) {
+                    byDay.push_back(index + 1);
+                }
+            }
+        }
+        else if (key == "BYMONTHDAY") {
+            for (const QString& text : value.split(',')) {
+                bool ok = false;
+                const int day = text.toInt(&ok);
+                if (!ok || day == 0 || qAbs(day) > 31) {
+                    unsupported << part;
+                    break;
+                }
+                byMonthDay.push_back(day);
+            }
+        }
+        else if (key.startsWith("BY") || key == "RSCALE" || key == "SKIP") {
+            // BYSETPOS、BYMONTH、BYWEEKNO、BYYEARDAY 等不展开；
+            // BYHOUR/BYMINUTE/BYSECOND 只影响一天内的时刻，按天展开时可以忽略
+            if (key != "BYHOUR" && key != "BYMINUTE" && key != "BYSECOND") {
+                unsupported << part;
+            }
+        }
+    }
+
+    // 各频率支持的 BY* 组合：DAILY 不带 BY*；WEEKLY 只带不含序号的 BYDAY；
+    // MONTHLY 带 BYDAY（可含序号）或 BYMONTHDAY 之一；YEARLY 不带 BY*
+    const bool hasOrdinal = byOrdinalDay.size() != byDay.size();
+    if ((freq == "DAILY" && (!byOrdinalDay.empty() || !byMonthDay.empty()))
+        || (freq == "WEEKLY" && (hasOrdinal || !byMonthDay.empty()))
+        || (freq == "MONTHLY" && !byOrdinalDay.empty() && !byMonthDay.empty())
+        || (freq == "YEARLY" && (!byOrdinalDay.empty() || !byMonthDay.empty()))) {
+        unsupported << QString("FREQ=%1 与 BYDAY/BYMONTHDAY 的组合").arg(freq);
+    }
+    if (!unsupported.isEmpty()) {
+        // 按错误的规则展开会把规则套到不相干的日期上，宁可只算第一次
+        qWarning() << "不支持的重复规则部分" << unsupported << "，只按单次事件处理:" << event.summary << event.rrule;
+        addSpan(event.start, span, rule, termStart, termEnd);
+        return;
+    }
+
+    QDate limit = termEnd;
+    if (until.isValid() && until < limit) {
+        limit = until;
+    }
+
+    auto excluded = [&event](const QDate& date) {
+        return std::find(event.exdates.begin(), event.exdates.end(), date) != event.exdates.end();
+    };
+
+    int occurrences = 0;
+    auto emitOccurrence = [&](const QDate& date) {
+        occurrences++;
+        if (!excluded(date)) {
+            addSpan(date, span, rule, termStart, termEnd);
+        }
+    };
+    auto reachedCount = [&]() { return count >= 0 && occurrences >= count; };
+
+    if (freq == "DAILY" || (freq == "WEEKLY" && byDay.empty())) {
+        const int step = freq == "DAILY" ? interval : interval * 7;
+        QDate date = event.start;
+        if (count < 0) {
+            // 没有次数限制时直接跳到学期开始附近，不逐次展开历史
+            const qint64 skip = (event.start.daysTo(termStart) - span) / step;
+            if (skip > 0) {
+                date = event.start.addDays(skip * step);
+            }
+        }
+        for (; date <= limit && !reachedCount(); date = date.addDays(step)) {
+            emitOccurrence(date);
+        }
+    }
+    else if (freq == "WEEKLY") {
+        std::sort(byDay.begin(), byDay.end());
+        QDate week = event.start.addDays(1 - event.start.dayOfWeek()); // 周一开始
+        if (count < 0) {
+            const qint64 skip = (week.daysTo(termStart) - span) / (7 * interval);
+            if (skip > 0) {
+                week = week.addDays(skip * 7 * interval);
+            }
+        }
+        for (; week <= limit && !reachedCount(); week = week.addDays(7 * interval)) {
+            for (int weekday : byDay) {
+                const QDate date = week.addDays(weekday - 1);
+                if (date < event.start) {
+                    continue;
+                }
+                if (date > limit || reachedCount()) {
+                    break;
+                }
+                emitOccurrence(date);
+            }
+        }
+    }
+    else if (freq == "MONTHLY" && (!byOrdinalDay.empty() || !byMonthDay.empty())) {
+        const QDate firstMonth(event.start.year(), event.start.month(), 1);
+        std::vector<QDate> dates;
+        for (int n = 0; n < kMaxPeriods && !reachedCount(); n += interval) {
+            const QDate month = firstMonth.addMonths(n);
+            if (month > limit) {
+                break;
+            }
+
+            // 收集该月所有命中的日期
+            const int daysInMonth = month.daysInMonth();
+            dates.clear();
+            for (int day : byMonthDay) {
+                const int dayOfMonth = day > 0 ? day : daysInMonth + day + 1;
+                if (dayOfMonth >= 1 && dayOfMonth <= daysInMonth) {
+                    dates.push_back(month.addDays(dayOfMonth - 1));
+                }
+            }
+            for (const auto& day : byOrdinalDay) {
+                const int ordinal = day.first;
+                const int weekday = day.second;
+                const int first = (weekday - month.dayOfWeek() + 7) % 7; // 该月第一个该星期的偏移
+                if (ordinal == 0) {
+                    for (int offset = first; offset < daysInMonth; offset += 7) {
+                        dates.push_back(month.addDays(offset));
+                    }
+                    continue;
+                }
+                const int weeksInMonth = (daysInMonth - 1 - first) / 7 + 1;
+                const int week = ordinal > 0 ? ordinal - 1 : weeksInMonth + ordinal;
+                if (week >= 0 && week < weeksInMonth) {
+                    dates.push_back(month.addDays(first + week * 7));
+                }
+            }
+            std::sort(dates.begin(), dates.end());
+            dates.erase(std::unique(dates.begin(), dates.end()), dates.end());
+
+            for (const QDate& date : dates) {
+                if (date < event.start) {
+                    continue;
+                }
+                if (date > limit || reachedCount()) {
+                    break;
+                }
+                emitOccurrence(date);
+            }
+        }
+    }
+    else if (freq == "MONTHLY" || freq == "YEARLY") {
+        for (int n = 0; n < kMaxPeriods && !reachedCount(); n += interval) {
+            const QDate date = freq == "MONTHLY" ? event.start.addMonths(n) : event.start.addYears(n);
+            if (date > limit) {
+                break;
+            }
+            // 该月/年没有这一天（如 31 日、2 月 29 日）时跳过
+            if (date.day() != event.start.day()) {
+                continue;
+            }
+            emitOccurrence(date);
+        }
+    }
+    else {
+        qDebug() << "不支持的重复规则，只按单次事件处理:" << event.rrule;
+        addSpan(event.start, span, rule, termStart, termEnd);
+    }
+}
+
+void TermCalendar::addSpan(const QDate& start, int days, int rule, const QDate& termStart, const QDate& termEnd)
+{
+    for (int i = 0; i < days; i++) {
+        const QDate date = start.addDays(i);
+        if (date > termEnd) {
+            break;
+        }
+        if (date >= termStart) {
+            m_days.emplace_back(date.toJulianDay(), rule);
+        }
+    }
+}
+
+QDate TermCalendar::parseDate(const QString& value, bool* allDay)
+{
+    const QString text = value.trimmed();
+    if (allDay) {
+        *allDay = !text.contains('T');
+    }
+    if (text.endsWith('Z')) {
+        // UTC 时间换算成本地日期
+        QDateTime utc = QDateTime::fromString(text, "yyyyMMdd'T'HHmmss'Z'");
+        utc.setTimeZone(QTimeZone::utc());
+        return utc.toLocalTime().date();
+    }
+    return QDate::fromString(text.left(8), "yyyyMMdd");
+}
+
+bool TermCalendar::readCache(const QString& cachePath, const QString& key)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    if (obj.value("key").toString() != key) {
+        return false;
+    }
+
+    // 平铺的 [儒略日, 规则, 儒略日, 规则, ...]
+    const QJsonArray days = obj.value("days").toArray();
+    m_days.clear();
+    m_days.reserve(days.size() / 2);
+    // 儒略日在 double 中可以精确表示（QJsonValue::toInteger 需要 Qt6）
+    for (int i = 0; i + 1 < days.size(); i += 2) {
+        m_days.emplace_back(qint64(days[i].toDouble()), days[i + 1].toInt());
+    }
+    return true;
+}
+
+void TermCalendar::writeCache(const QString& cachePath, const QString& key) const
+{
+    QJsonArray days;
+    for (const auto& day : m_days) {
+        days.append(day.first);
+        days.append(day.second);
+    }
+
+    QJsonObject obj;
+    obj["key"] = key;
+    obj["days"] = days;
+
+    QFile file(cachePath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        file.close();
+    }
+    else {
+        qDebug() << "保存日历缓存失败:" << file.errorString();
+    }
+}
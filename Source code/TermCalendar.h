@@ -0,0 +1,55 @@
+﻿#ifndef TERM_CALENDAR_H
+#define TERM_CALENDAR_H
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <utility>
+#include <vector>
+
+// 学期日历：逐行流式解析 .ics（不建立整个文件的 DOM），
+// 只展开匹配规则的事件，并把重复规则（RRULE）在学期范围内展开成
+// 按日期排序的紧凑表（日期 -> 规则下标）。展开结果缓存在磁盘上，
+// .ics 文件大小/修改时间、学期范围或规则不变时直接读取缓存。
+class TermCalendar
+{
+public:
+    TermCalendar();
+
+    // matches[i] 是第 i 条规则要匹配的文字（事件标题或分类中包含即命中），
+    // 同一天命中多条规则时下标小的优先。cachePath 为空时不缓存
+    bool load(const QString& icsPath, const QDate& termStart, const QDate& termEnd,
+        const QStringList& matches, const QString& cachePath);
+    void clear();
+
+    bool isEmpty() const { return m_days.empty(); }
+    // 该日期命中的规则下标，没有时返回 -1
+    int ruleForDate(const QDate& date) const;
+    // 展开后的天数
+    int dayCount() const { return int(m_days.size()); }
+
+    QString lastError() const { return m_lastError; }
+
+private:
+    struct Event {
+        QDate start;
+        QDate end;          // 不包含
+        QString summary;
+        QString categories;
+        QString rrule;
+        std::vector<QDate> exdates;
+    };
+
+    bool parse(const QString& icsPath, const QDate& termStart, const QDate& termEnd, const QStringList& matches);
+    void expand(const Event& event, int rule, const QDate& termStart, const QDate& termEnd);
+    void addSpan(const QDate& start, int days, int rule, const QDate& termStart, const QDate& termEnd);
+    static QDate parseDate(const QString& value, bool* allDay = nullptr);
+
+    bool readCache(const QString& cachePath, const QString& key);
+    void writeCache(const QString& cachePath, const QString& key) const;
+
+    std::vector<std::pair<qint64, int>> m_days; // 儒略日 -> 规则下标，按日期排序
+    QString m_lastError;
+};
+
+#endif // TERM_CALENDAR_H
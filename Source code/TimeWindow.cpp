@@ -1,24 +1,31 @@
-﻿#include "TimeWindow.h"
+﻿#define NOMINMAX
+#include "TimeWindow.h"
+#include "ClockSource.h"
+#include "EventLoopMonitor.h"
 #include <QApplication>
 #include <QScreen>
+#include <QWindow>
+#include <QTouchEvent>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
 
 TimeWindow::TimeWindow(QWidget* parent)
     : QWidget(parent),
     timeLabel(nullptr), dateLabel(nullptr), weekdayLabel(nullptr),
     datetimeTimer(nullptr),
-    m_dragging(false), m_movable(true), m_dragPosition(0, 0)  // 默认可移动
+    m_dragging(false), m_movable(true), m_dragPosition(0, 0),  // 默认可移动
+    m_dragMoved(false), m_hasPendingMove(false), m_dragTimer(nullptr)
 {
     // 设置无边框窗口和透明背景
     setWindowFlags(Qt::FramelessWindowHint | Qt::Tool | Qt::WindowStaysOnTopHint);
     setAttribute(Qt::WA_TranslucentBackground);
+    // 触摸屏上直接处理触摸事件，不依赖合成的鼠标事件
+    setAttribute(Qt::WA_AcceptTouchEvents);
 
     // 设置窗口位置和大小
-    QScreen* screen = QApplication::primaryScreen();
-    QRect screenGeometry = screen->geometry();
-    int windowWidth = 400;
-    int windowHeight = 150;
-    int xPos = screenGeometry.width() - windowWidth - 125; // 在课程表窗口左侧125像素
-    setGeometry(xPos, 0, windowWidth, windowHeight);
+    placeOnScreen(QApplication::primaryScreen()->geometry());
 
     // 设置透明背景
     setStyleSheet("background: transparent;");
@@ -30,6 +37,7 @@ TimeWindow::TimeWindow(QWidget* parent)
 
     // 时间标签
     timeLabel = new QLabel(this);
+    timeLabel->setObjectName("timeLabel");
     timeLabel->setStyleSheet("font-size: 80px; font-weight: bold; color: black; background: transparent;");
     timeLabel->setAlignment(Qt::AlignLeft);
     timeLabel->setMinimumHeight(90);
@@ -41,9 +49,11 @@ TimeWindow::TimeWindow(QWidget* parent)
     dateLayout->setSpacing(20);
 
     dateLabel = new QLabel(this);
+    dateLabel->setObjectName("dateLabel");
     dateLabel->setStyleSheet("font-size: 24px; font-weight: bold; color: black; background: transparent;");
 
     weekdayLabel = new QLabel(this);
+    weekdayLabel->setObjectName("weekdayLabel");
     weekdayLabel->setStyleSheet("font-size: 24px; font-weight: bold; color: black; background: transparent;");
 
     dateLayout->addWidget(dateLabel);
@@ -52,11 +62,19 @@ TimeWindow::TimeWindow(QWidget* parent)
 
     layout->addLayout(dateLayout);
 
+    // 拖动合并定时器
+    m_dragTimer = new QTimer(this);
+    m_dragTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_dragTimer, &QTimer::timeout, this, &TimeWindow::applyPendingMove);
+
     // 启动定时器
     datetimeTimer = new QTimer(this);
     connect(datetimeTimer, &QTimer::timeout, this, &TimeWindow::updateDateTime);
     datetimeTimer->start(1000);
 
+    // 时间跳变（系统时间调整、虚拟时钟设定）时立即刷新
+    connect(ClockSource::instance(), &ClockSource::timeJumped, this, &TimeWindow::updateDateTime, Qt::QueuedConnection);
+
     // 立即更新一次
     updateDateTime();
 
@@ -75,7 +93,8 @@ TimeWindow::~TimeWindow()
 
 void TimeWindow::updateDateTime()
 {
-    QDateTime now = QDateTime::currentDateTime();
+    EventLoopMonitor::ActivityScope activity("TimeWindow::updateDateTime");
+    QDateTime now = ClockSource::instance()->now();
 
     dateLabel->setText(now.toString("  yyyy年MM月dd日"));
     timeLabel->setText(now.toString("HH:mm:ss"));
@@ -99,17 +118,138 @@ void TimeWindow::setMovable(bool movable)
     m_movable = movable;
 }
 
+// 放到指定屏幕区域的默认位置
+void TimeWindow::placeOnScreen(const QRect& screenGeometry)
+{
+    int windowWidth = 400;
+    int windowHeight = 150;
+    setGeometry(QRect(defaultPosition(screenGeometry), QSize(windowWidth, windowHeight)));
+}
+
+QPoint TimeWindow::defaultPosition(const QRect& screenGeometry)
+{
+    int windowWidth = 400;
+    int xPos = screenGeometry.x() + screenGeometry.width() - windowWidth - 125; // 在课程表窗口左侧125像素
+    return QPoint(xPos, screenGeometry.y());
+}
+
+// 切换置顶/普通层级
+void TimeWindow::setTopmost(bool topmost)
+{
+    // 置顶模式下时间窗口只做显示，点击穿透到下层
+    Qt::WindowFlags flags = Qt::FramelessWindowHint | Qt::Tool;
+    if (topmost) {
+        flags |= Qt::WindowStaysOnTopHint | Qt::WindowTransparentForInput;
+    }
+
+    if (windowFlags() == flags) {
+        return;
+    }
+
+    // QWidget::setWindowFlags 会销毁并重建原生窗口，导致闪烁和整窗重绘；
+    // 这里只同步 QWidget 记录的标志，再直接修改已有的原生窗口
+    overrideWindowFlags(flags);
+
+    QWindow* handle = windowHandle();
+    if (!handle) {
+        return; // 原生窗口尚未创建，首次显示时会使用上面的标志
+    }
+    handle->setFlags(flags);
+
+#ifdef Q_OS_WIN
+    // 确保层级立即生效，不激活、不移动窗口
+    SetWindowPos(reinterpret_cast<HWND>(winId()), topmost ? HWND_TOPMOST : HWND_NOTOPMOST,
+        0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_NOOWNERZORDER);
+#endif
+}
+
+// 开始拖动
+void TimeWindow::beginDrag(const QPoint& globalPos)
+{
+    m_dragging = true;
+    m_dragMoved = false;
+    m_hasPendingMove = false;
+    m_pressGlobalPos = globalPos;
+    m_dragStartPos = pos();
+    m_dragPosition = globalPos - frameGeometry().topLeft();
+
+    // 每帧最多移动一次窗口
+    QScreen* current = screen();
+    double refreshRate = (current && current->refreshRate() > 0) ? current->refreshRate() : 60.0;
+    m_dragTimer->setInterval(qMax(1, int(1000.0 / refreshRate)));
+}
+
+// 拖动中只记录目标位置，由定时器合并后移动
+void TimeWindow::updateDrag(const QPoint& globalPos)
+{
+    // 指针移动未超过系统拖动阈值时视为点按，不移动窗口
+    if (!m_dragMoved) {
+        if ((globalPos - m_pressGlobalPos).manhattanLength() < QApplication::startDragDistance()) {
+            return;
+        }
+        m_dragMoved = true;
+    }
+    m_pendingPos = globalPos - m_dragPosition;
+    m_hasPendingMove = true;
+    if (!m_dragTimer->isActive()) {
+        // 第一次移动立即响应，之后按帧合并
+        applyPendingMove();
+        m_dragTimer->start();
+    }
+}
+
+// 结束拖动，移动到最终位置并通知保存；只是点按时不保存，
+// 否则会把防烧屏偏移后的位置当作用户设置写回
+void TimeWindow::endDrag(const QPoint& globalPos)
+{
+    m_dragTimer->stop();
+    m_dragging = false;
+    if (!m_dragMoved
+        && (globalPos - m_pressGlobalPos).manhattanLength() < QApplication::startDragDistance()) {
+        m_hasPendingMove = false;
+        return;
+    }
+    m_dragMoved = false;
+    m_pendingPos = globalPos - m_dragPosition;
+    m_hasPendingMove = true;
+    applyPendingMove();
+    emit dragFinished(pos());
+}
+
+void TimeWindow::cancelDrag()
+{
+    m_dragTimer->stop();
+    m_dragging = false;
+    m_hasPendingMove = false;
+    if (m_dragMoved && pos() != m_dragStartPos) {
+        move(m_dragStartPos);
+    }
+    m_dragMoved = false;
+}
+
+void TimeWindow::applyPendingMove()
+{
+    if (!m_hasPendingMove) {
+        // 这一帧没有新的移动，停止定时器，空闲时不再唤醒
+        m_dragTimer->stop();
+        return;
+    }
+    m_hasPendingMove = false;
+    if (m_pendingPos != pos()) {
+        move(m_pendingPos);
+    }
+}
+
 // 鼠标按下事件 - 开始拖动
 void TimeWindow::mousePressEvent(QMouseEvent* event)
 {
     if (!m_movable) return; // 如果不可移动，直接返回
 
     if (event->button() == Qt::LeftButton) {
-        m_dragging = true;
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        m_dragPosition = event->globalPosition().toPoint() - frameGeometry().topLeft();
+        beginDrag(event->globalPosition().toPoint());
 #else
-        m_dragPosition = event->globalPos() - frameGeometry().topLeft();
+        beginDrag(event->globalPos());
 #endif
         event->accept();
     }
@@ -122,9 +262,9 @@ void TimeWindow::mouseMoveEvent(QMouseEvent* event)
 
     if (m_dragging && (event->buttons() & Qt::LeftButton)) {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        move(event->globalPosition().toPoint() - m_dragPosition);
+        updateDrag(event->globalPosition().toPoint());
 #else
-        move(event->globalPos() - m_dragPosition);
+        updateDrag(event->globalPos());
 #endif
         event->accept();
     }
@@ -135,8 +275,53 @@ void TimeWindow::mouseReleaseEvent(QMouseEvent* event)
 {
     if (!m_movable) return; // 如果不可移动，直接返回
 
-    if (event->button() == Qt::LeftButton) {
-        m_dragging = false;
+    if (event->button() == Qt::LeftButton && m_dragging) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        endDrag(event->globalPosition().toPoint());
+#else
+        endDrag(event->globalPos());
+#endif
         event->accept();
     }
+}
+
+// 触摸事件 - 第一个触点拖动窗口，接受 TouchBegin 后不再合成鼠标事件
+bool TimeWindow::event(QEvent* event)
+{
+    switch (event->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel: {
+        QTouchEvent* touch = static_cast<QTouchEvent*>(event);
+        if (!m_movable) {
+            touch->ignore();
+            return false;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        const QList<QEventPoint>& points = touch->points();
+        const QPoint globalPos = points.isEmpty() ? pos() + m_dragPosition : points.first().globalPosition().toPoint();
+#else
+        const QList<QTouchEvent::TouchPoint>& points = touch->touchPoints();
+        const QPoint globalPos = points.isEmpty() ? pos() + m_dragPosition : points.first().screenPos().toPoint();
+#endif
+        if (event->type() == QEvent::TouchBegin) {
+            beginDrag(globalPos);
+        }
+        else if (event->type() == QEvent::TouchUpdate && m_dragging) {
+            updateDrag(globalPos);
+        }
+        else if (event->type() == QEvent::TouchCancel && m_dragging) {
+            cancelDrag();
+        }
+        else if (m_dragging) {
+            endDrag(globalPos);
+        }
+        touch->accept();
+        return true;
+    }
+    default:
+        break;
+    }
+    return QWidget::event(event);
 }
\ No newline at end of file
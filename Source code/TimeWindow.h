@@ -15,6 +15,11 @@ class TimeWindow : public QWidget
 {
     Q_OBJECT
 
+    // 模拟器、快照渲染和浸泡测试需要直接驱动内部定时器
+    friend class WeekSimulator;
+    friend class SnapshotRenderer;
+    friend class SoakTest;
+
 public:
     explicit TimeWindow(QWidget* parent = nullptr);
     ~TimeWindow();
@@ -25,14 +30,32 @@ public:
     // 设置是否可移动
     void setMovable(bool movable);
 
+    // 切换置顶/普通层级（保留原生窗口，不重建）
+    void setTopmost(bool topmost);
+
+    // 放到指定屏幕区域的默认位置
+    void placeOnScreen(const QRect& screenGeometry);
+    // 默认位置的左上角
+    static QPoint defaultPosition(const QRect& screenGeometry);
+
+    // 是否正在拖动
+    bool isDragging() const { return m_dragging; }
+
+signals:
+    // 拖动结束，参数为窗口最终左上角（全局坐标）；只点按未拖动或触摸被取消时不发出
+    void dragFinished(const QPoint& topLeft);
+
 private slots:
     void updateDateTime();
+    void applyPendingMove();
 
 protected:
     // 鼠标事件处理
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
+    // 触摸事件处理
+    bool event(QEvent* event) override;
 
 private:
     QLabel* timeLabel;
@@ -40,10 +63,22 @@ private:
     QLabel* weekdayLabel;
     QTimer* datetimeTimer;
 
-    // 拖动相关变量
+    // 拖动相关：移动事件只记录目标位置，每帧最多移动一次窗口
+    void beginDrag(const QPoint& globalPos);
+    void updateDrag(const QPoint& globalPos);
+    void endDrag(const QPoint& globalPos);
+    // 触摸被系统取消：回到拖动前的位置，不保存
+    void cancelDrag();
+
     bool m_dragging;
     bool m_movable; // 控制是否可移动
     QPoint m_dragPosition;
+    QPoint m_pressGlobalPos; // 按下时的指针位置
+    QPoint m_dragStartPos;   // 按下时的窗口位置
+    bool m_dragMoved;        // 指针移动是否超过拖动阈值
+    QPoint m_pendingPos;   // 下一帧要移动到的位置
+    bool m_hasPendingMove;
+    QTimer* m_dragTimer;   // 按屏幕刷新率合并拖动
 };
 
 #endif // TIMEWINDOW_H
\ No newline at end of file
@@ -0,0 +1,247 @@
+﻿#include "WeekSimulator.h"
+#include "ClassScheduleApp.h"
+#include "TimeWindow.h"
+#include "ClockSource.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QWidget>
+#include <QDebug>
+
+WeekSimulator::WeekSimulator(ClassScheduleApp* app, VirtualClock* clock, const Options& options, QObject* parent)
+    : QObject(parent),
+    m_app(app), m_clock(clock), m_options(options),
+    m_pendingPaints(0), m_pendingLayoutRequests(0), m_pendingPaintNs(0)
+{
+}
+
+int WeekSimulator::run()
+{
+    qInfo() << "=== 开始周模拟 ===" << m_clock->now().toString("yyyy-MM-dd HH:mm:ss")
+        << "天数:" << m_options.days;
+
+    connect(m_app, &ClassScheduleApp::displayModeChanged, this, [this](bool isTopmost) {
+        DayStats& day = currentDay();
+        day.modeSwitches++;
+        day.maxModeSwitchMs = qMax(day.maxModeSwitchMs, m_app->lastModeSwitchMs);
+        recordEvent("mode", QString("%1 %2ms").arg(isTopmost ? "topmost" : "normal")
+            .arg(m_app->lastModeSwitchMs, 0, 'f', 2));
+    });
+    connect(m_app, &ClassScheduleApp::courseListRebuilt, this, [this](int courseCount) {
+        currentDay().courseListRebuilds++;
+        recordEvent("courses", QString::number(courseCount));
+    });
+
+    qApp->installEventFilter(this);
+    takeOverTimers();
+
+    // 先把构造期间挂起的事件处理掉，作为第一天的基线
+    dispatchPendingEvents();
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    const qint64 endMs = qint64(m_options.days) * 24 * 60 * 60 * 1000;
+    qint64 elapsedMs = 0;
+
+    while (!m_timers.empty()) {
+        // 找到下一个到期的定时器
+        SimTimer* next = &m_timers.front();
+        for (SimTimer& timer : m_timers) {
+            if (timer.nextDueMs < next->nextDueMs) {
+                next = &timer;
+            }
+        }
+        if (next->nextDueMs > endMs) {
+            break;
+        }
+
+        m_clock->advance(next->nextDueMs - elapsedMs);
+        elapsedMs = next->nextDueMs;
+
+        DayStats& day = currentDay();
+        day.wakeups++;
+        day.wakeupsByTimer[next->name]++;
+
+        next->fire();
+        dispatchPendingEvents();
+        checkInvariants(*next);
+
+        next->nextDueMs += next->intervalMs;
+    }
+
+    qApp->removeEventFilter(this);
+
+    const qint64 wallMs = wallTimer.elapsed();
+    writeReport(wallMs);
+
+    qInfo() << "=== 周模拟完成 === 耗时" << wallMs << "ms，异常" << m_anomalies.size() << "个";
+    return m_anomalies.isEmpty() ? 0 : 1;
+}
+
+void WeekSimulator::takeOverTimers()
+{
+    // 停掉真实定时器，改由虚拟时间驱动
+    auto addTimer = [this](const QString& name, QTimer* timer, std::function<void()> fire) {
+        if (!timer) {
+            return;
+        }
+        timer->stop();
+        SimTimer simTimer{ name, timer, std::move(fire), qMax(1, timer->interval()), 0 };
+        simTimer.nextDueMs = simTimer.intervalMs;
+        m_timers.push_back(simTimer);
+    };
+
+    addTimer("datetime", m_app->datetimeTimer, [this]() { m_app->updateDateTime(); });
+    addTimer("topmost", m_app->topmostCheckTimer, [this]() { m_app->checkTopmostStatus(); });
+    addTimer("pixelShift", m_app->pixelShiftTimer, [this]() { m_app->pixelShift(); });
+    if (m_app->timeWindow) {
+        TimeWindow* timeWindow = m_app->timeWindow;
+        addTimer("clock", timeWindow->datetimeTimer, [timeWindow]() { timeWindow->updateDateTime(); });
+    }
+}
+
+void WeekSimulator::dispatchPendingEvents()
+{
+    m_pendingPaints = 0;
+    m_pendingLayoutRequests = 0;
+    m_pendingPaintNs = 0;
+
+    // deleteLater 在没有事件循环时不会自动执行，这里手动触发
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QCoreApplication::processEvents();
+    finishPaint();
+
+    DayStats& day = currentDay();
+    day.paints += m_pendingPaints;
+    day.layoutRequests += m_pendingLayoutRequests;
+    day.paintNs += m_pendingPaintNs;
+}
+
+void WeekSimulator::finishPaint()
+{
+    if (m_paintTimer.isValid()) {
+        m_pendingPaintNs += m_paintTimer.nsecsElapsed();
+        m_paintTimer.invalidate();
+    }
+}
+
+bool WeekSimulator::eventFilter(QObject* watched, QEvent* event)
+{
+    // 不自己分发绘制事件（否则会跳过控件上的事件过滤器，如 QScrollArea 视口的绘制转发），
+    // 而是把一次重绘中各控件的绘制事件首尾相接计时：上一个绘制到下一个事件到达时结束，
+    // 最后一个绘制在 dispatchPendingEvents 处理完事件后结束
+    finishPaint();
+
+    if (event->type() == QEvent::LayoutRequest) {
+        m_pendingLayoutRequests++;
+    }
+    else if (event->type() == QEvent::Paint && watched->isWidgetType()) {
+        m_pendingPaints++;
+        m_paintTimer.start();
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+void WeekSimulator::checkInvariants(const SimTimer& timer)
+{
+    if (timer.name == "topmost") {
+        const bool expected = m_app->shouldBeTopmost();
+        if (m_app->currentTopmostState != expected) {
+            recordAnomaly(QString("置顶状态不一致: 当前 %1, 应为 %2")
+                .arg(m_app->currentTopmostState).arg(expected));
+        }
+        if (m_app->isVisible() == m_app->currentTopmostState) {
+            recordAnomaly(QString("课程表窗口可见性与模式不符: visible=%1, topmost=%2")
+                .arg(m_app->isVisible()).arg(m_app->currentTopmostState));
+        }
+    }
+    else if (timer.name == "datetime") {
+        const QDate today = m_clock->currentDate();
+        if (m_app->currentDate != today) {
+            recordAnomaly(QString("日期未更新: 当前 %1, 应为 %2")
+                .arg(m_app->currentDate.toString(Qt::ISODate), today.toString(Qt::ISODate)));
+        }
+    }
+}
+
+void WeekSimulator::recordEvent(const QString& kind, const QString& detail)
+{
+    m_eventLog.append(QString("%1 %2 %3")
+        .arg(m_clock->now().toString("yyyy-MM-dd HH:mm:ss"), kind, detail));
+}
+
+void WeekSimulator::recordAnomaly(const QString& message)
+{
+    const QString entry = m_clock->now().toString("yyyy-MM-dd HH:mm:ss") + " " + message;
+    m_anomalies.append(entry);
+    qWarning() << "模拟异常:" << entry;
+}
+
+WeekSimulator::DayStats& WeekSimulator::currentDay()
+{
+    const QDate today = m_clock->currentDate();
+    if (m_days.empty() || m_days.back().date != today) {
+        DayStats day;
+        day.date = today;
+        m_days.push_back(day);
+    }
+    return m_days.back();
+}
+
+void WeekSimulator::writeReport(qint64 wallMs)
+{
+    QJsonArray days;
+    for (const DayStats& day : m_days) {
+        QJsonObject wakeupsByTimer;
+        for (auto it = day.wakeupsByTimer.constBegin(); it != day.wakeupsByTimer.constEnd(); ++it) {
+            wakeupsByTimer[it.key()] = it.value();
+        }
+
+        QJsonObject dayObj;
+        dayObj["date"] = day.date.toString("yyyy-MM-dd");
+        dayObj["wakeups"] = day.wakeups;
+        dayObj["wakeups_by_timer"] = wakeupsByTimer;
+        dayObj["course_list_rebuilds"] = day.courseListRebuilds;
+        dayObj["mode_switches"] = day.modeSwitches;
+        dayObj["max_mode_switch_ms"] = day.maxModeSwitchMs;
+        dayObj["paints"] = day.paints;
+        dayObj["layout_requests"] = day.layoutRequests;
+        dayObj["paint_ms"] = day.paintNs / 1000000.0;
+        days.append(dayObj);
+
+        qInfo().noquote() << day.date.toString("yyyy-MM-dd")
+            << "唤醒" << day.wakeups
+            << "重建" << day.courseListRebuilds
+            << "切换" << day.modeSwitches
+            << "重绘" << day.paints
+            << "绘制耗时" << QString::number(day.paintNs / 1000000.0, 'f', 1) << "ms";
+    }
+
+    QJsonObject report;
+    report["start"] = m_options.start.toString(Qt::ISODate);
+    report["simulated_days"] = m_options.days;
+    report["wall_ms"] = wallMs;
+    report["days"] = days;
+    report["events"] = QJsonArray::fromStringList(m_eventLog);
+    report["anomalies"] = QJsonArray::fromStringList(m_anomalies);
+
+    if (m_options.reportPath.isEmpty()) {
+        return;
+    }
+
+    QFile file(m_options.reportPath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+        file.close();
+        qInfo() << "模拟报告已保存:" << m_options.reportPath;
+    }
+    else {
+        qWarning() << "保存模拟报告失败:" << file.errorString();
+    }
+}
@@ -0,0 +1,86 @@
+﻿#ifndef WEEK_SIMULATOR_H
+#define WEEK_SIMULATOR_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+#include <vector>
+
+class ClassScheduleApp;
+class VirtualClock;
+
+// 加速周模拟：在 offscreen 平台下用虚拟时钟快进课表，
+// 记录每次模式切换、课程列表重建、定时器唤醒和重绘
+class WeekSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QDateTime start;          // 模拟起始时间
+        int days = 7;             // 模拟天数
+        QString reportPath;       // JSON 报告输出路径，为空则只打印
+    };
+
+    WeekSimulator(ClassScheduleApp* app, VirtualClock* clock, const Options& options, QObject* parent = nullptr);
+
+    // 运行模拟，返回进程退出码（发现异常时非 0）
+    int run();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    // 被接管的定时器
+    struct SimTimer {
+        QString name;
+        QTimer* timer;
+        std::function<void()> fire;
+        qint64 intervalMs;
+        qint64 nextDueMs;
+    };
+
+    // 每个模拟日的统计
+    struct DayStats {
+        QDate date;
+        int wakeups = 0;
+        int courseListRebuilds = 0;
+        int modeSwitches = 0;
+        int paints = 0;
+        int layoutRequests = 0;
+        qint64 paintNs = 0;
+        double maxModeSwitchMs = 0.0;
+        QMap<QString, int> wakeupsByTimer;
+    };
+
+    void takeOverTimers();
+    void dispatchPendingEvents();
+    void finishPaint();
+    void checkInvariants(const SimTimer& timer);
+    void recordEvent(const QString& kind, const QString& detail);
+    void recordAnomaly(const QString& message);
+    DayStats& currentDay();
+    void writeReport(qint64 wallMs);
+
+    ClassScheduleApp* m_app;
+    VirtualClock* m_clock;
+    Options m_options;
+
+    std::vector<SimTimer> m_timers;
+    std::vector<DayStats> m_days;
+    QStringList m_eventLog;
+    QStringList m_anomalies;
+
+    int m_pendingPaints;
+    int m_pendingLayoutRequests;
+    qint64 m_pendingPaintNs;
+    QElapsedTimer m_paintTimer; // 从收到绘制事件计到下一个事件，无效表示当前不在绘制
+
+};
+
+#endif // WEEK_SIMULATOR_H
@@ -1,10 +1,243 @@
 ﻿#include "ClassScheduleApp.h"
+#include "ClockSource.h"
+#include "WeekSimulator.h"
+#include "SnapshotRenderer.h"
+#include "SoakTest.h"
+#include "SettingsModel.h"
+#include "ScreenManager.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
+#include <QDir>
+#include <QFile>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+bool hasArgument(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString argumentValue(int argc, char* argv[], const char* name)
+{
+    for (int i = 1; i < argc - 1; i++) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return QString::fromLocal8Bit(argv[i + 1]);
+        }
+    }
+    return QString();
+}
+
+// offscreen 平台默认只有 800x600 的屏幕，快照时按大屏分辨率生成屏幕配置
+void useOffscreenPlatform(const QString& screenSize)
+{
+    if (!qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        return;
+    }
+
+    const QStringList parts = screenSize.split('x');
+    const int width = parts.size() == 2 ? parts[0].toInt() : 0;
+    const int height = parts.size() == 2 ? parts[1].toInt() : 0;
+    if (width <= 0 || height <= 0) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        return;
+    }
+
+    const QString configPath = QDir::temp().absoluteFilePath("class_schedule_offscreen.json");
+    QFile config(configPath);
+    if (config.open(QIODevice::WriteOnly)) {
+        config.write(QString("{\"screens\": [{\"name\": \"Board\", \"x\": 0, \"y\": 0, "
+            "\"width\": %1, \"height\": %2, \"logicalDpi\": 96, \"logicalBaseDpi\": 96, \"dpr\": 1}]}")
+            .arg(width).arg(height).toUtf8());
+        config.close();
+        qputenv("QT_QPA_PLATFORM", QString("offscreen:configfile=%1").arg(configPath).toLocal8Bit());
+    }
+    else {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+}
+
+// 无界面模式下屏蔽逐秒的调试输出，否则日志本身会成为瓶颈
+void headlessMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    if (type == QtDebugMsg) {
+        return;
+    }
+    Q_UNUSED(context);
+    fprintf(stderr, "%s\n", qPrintable(message));
+}
+
+int runSimulation(QApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "simulate-week", "在 offscreen 平台下快进模拟课表" });
+    parser.addOption({ "sim-start", "模拟起始时间 (ISO 格式，默认本周一 00:00)", "datetime" });
+    parser.addOption({ "sim-days", "模拟天数 (默认 7)", "days", "7" });
+    parser.addOption({ "sim-report", "JSON 报告输出路径", "path" });
+    parser.process(app);
+
+    WeekSimulator::Options options;
+    options.start = QDateTime::fromString(parser.value("sim-start"), Qt::ISODate);
+    if (!options.start.isValid()) {
+        QDate today = QDate::currentDate();
+        options.start = QDateTime(today.addDays(1 - today.dayOfWeek()), QTime(0, 0));
+    }
+    options.days = qMax(1, parser.value("sim-days").toInt());
+    options.reportPath = parser.value("sim-report");
+
+    qInstallMessageHandler(headlessMessageHandler);
+
+    VirtualClock clock(options.start);
+    ClockSource::setInstance(&clock);
+
+    AppOptions appOptions;
+    appOptions.autoStart = false;
+    appOptions.persistSettings = false;
+    appOptions.monitorEventLoop = false;
+
+    int exitCode = 0;
+    {
+        ClassScheduleApp w(appOptions);
+        WeekSimulator simulator(&w, &clock, options);
+        exitCode = simulator.run();
+    }
+
+    ClockSource::setInstance(nullptr);
+    return exitCode;
+}
+
+int runSnapshots(QApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "snapshot", "在 offscreen 平台下批量渲染快照" });
+    parser.addOption({ "snapshot-jobs", "JSON 任务文件 [{config, time, output}]", "path" });
+    parser.addOption({ "snapshot-config", "设置文件路径（配合 --snapshot-time 使用）", "path" });
+    parser.addOption({ "snapshot-time", "快照时间 (ISO 格式，可重复)", "datetime" });
+    parser.addOption({ "snapshot-out", "输出目录 (默认当前目录)", "dir", "." });
+    parser.addOption({ "snapshot-size", "屏幕分辨率 (默认 1920x1080)", "WxH", "1920x1080" });
+    parser.process(app);
+
+    qInstallMessageHandler(headlessMessageHandler);
+
+    const QString outputDir = parser.value("snapshot-out");
+    std::vector<SnapshotRenderer::Job> jobs;
+
+    if (parser.isSet("snapshot-jobs")) {
+        QString error;
+        if (!SnapshotRenderer::loadJobs(parser.value("snapshot-jobs"), outputDir, jobs, &error)) {
+            qWarning().noquote() << error;
+            return 1;
+        }
+    }
+
+    const QString configPath = QDir::current().absoluteFilePath(parser.value("snapshot-config"));
+    for (const QString& value : parser.values("snapshot-time")) {
+        const QDateTime time = QDateTime::fromString(value, Qt::ISODate);
+        if (!time.isValid() || !parser.isSet("snapshot-config")) {
+            qWarning().noquote() << "无效的快照参数:" << value;
+            return 1;
+        }
+        jobs.push_back({ configPath, time, SnapshotRenderer::defaultOutputPath(outputDir, configPath, time) });
+    }
+
+    SnapshotRenderer renderer;
+    return renderer.run(jobs);
+}
+
+int runSoakTest(QApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "soak", "加速长时间运行测试，检查内存和句柄增长（在原生平台上运行）" });
+    parser.addOption({ "soak-days", "模拟天数 (默认 30)", "days", "30" });
+    parser.addOption({ "soak-report", "CSV 采样输出路径", "path" });
+    parser.addOption({ "soak-max-rss-growth-kb", "预热后常驻内存增长上限 (KB)", "kb", "32768" });
+    parser.addOption({ "soak-max-private-growth-kb", "预热后私有字节增长上限 (KB)", "kb", "32768" });
+    parser.addOption({ "soak-max-object-growth", "预热后 QObject/控件数量增长上限", "count", "50" });
+    parser.addOption({ "soak-max-handle-growth", "预热后句柄/GDI 对象增长上限", "count", "32" });
+    parser.process(app);
+
+    SoakTest::Options options;
+    options.days = qMax(1, parser.value("soak-days").toInt());
+    options.reportPath = parser.value("soak-report");
+    options.maxRssGrowthKb = parser.value("soak-max-rss-growth-kb").toLongLong();
+    options.maxPrivateGrowthKb = parser.value("soak-max-private-growth-kb").toLongLong();
+    options.maxObjectGrowth = parser.value("soak-max-object-growth").toInt();
+    options.maxHandleGrowth = parser.value("soak-max-handle-growth").toInt();
+
+    qInstallMessageHandler(headlessMessageHandler);
+
+    QDate today = QDate::currentDate();
+    VirtualClock clock(QDateTime(today.addDays(1 - today.dayOfWeek()), QTime(0, 0)));
+    ClockSource::setInstance(&clock);
+
+    AppOptions appOptions;
+    appOptions.autoStart = false;
+    appOptions.persistSettings = false;
+    appOptions.monitorEventLoop = false;
+
+    int exitCode = 0;
+    {
+        ClassScheduleApp w(appOptions);
+        SoakTest soakTest(&w, &clock, options);
+        exitCode = soakTest.run();
+    }
+
+    ClockSource::setInstance(nullptr);
+    return exitCode;
+}
+
+} // namespace
 
 int main(int argc, char* argv[])
 {
+    const bool simulate = hasArgument(argc, argv, "--simulate-week");
+    const bool snapshot = hasArgument(argc, argv, "--snapshot");
+    const bool soak = hasArgument(argc, argv, "--soak");
+    if (simulate && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        // 模拟不需要真实显示器
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // 浸泡测试使用原生平台，才会创建真实的窗口句柄和 GDI/USER 对象
+    if (snapshot) {
+        const QString size = argumentValue(argc, argv, "--snapshot-size");
+        useOffscreenPlatform(size.isEmpty() ? QString("1920x1080") : size);
+    }
+
     QApplication a(argc, argv);
-    ClassScheduleApp w;
-    w.show();
+
+    if (simulate) {
+        return runSimulation(a);
+    }
+    if (snapshot) {
+        return runSnapshots(a);
+    }
+    if (soak) {
+        return runSoakTest(a);
+    }
+
+    AppOptions appOptions;
+    appOptions.profileOverlay = hasArgument(argc, argv, "--profile-overlay");
+    appOptions.monitorEventLoop = !hasArgument(argc, argv, "--no-event-loop-monitor");
+
+    // 所有屏幕上的实例共用一份设置
+    SettingsModel settingsModel(appOptions.settingsPath, appOptions.persistSettings);
+    settingsModel.load();
+    if (!settingsModel.lastError().isEmpty()) {
+        // 不再静默回退到默认设置，提示管理员检查
+        QMessageBox::warning(nullptr, "设置文件错误", settingsModel.lastError());
+    }
+
+    ScreenManager screenManager(&settingsModel, appOptions);
+    screenManager.start();
     return a.exec();
-}
\ No newline at end of file
+}